@@ -0,0 +1,124 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+/**
+ * This sketch counts the CPU cycles of the receiver interrupt handler on an
+ * AVR micro controller, like the ATmega328P of the Arduino UNO. It reports
+ * the cycles per receiver state and protocol table, for generated pulses
+ * and for recorded pulses.
+ *
+ * Reproducible cycle counts can be obtained on a Linux machine without any
+ * board, by running the sketch on the cycle accurate simulator simavr:
+ *
+ * 1) The benchmark is part of the library tests. Build the sketch with the
+ *    compiler option -DENABLE_RCSWITCH_TEST, e.g.
+ *    arduino-cli compile --fqbn arduino:avr:uno
+ *        --build-property "compiler.cpp.extra_flags=-DENABLE_RCSWITCH_TEST"
+ *        --output-dir build examples/BenchmarkAvrCycles
+ * 2) Run the elf file on the simulator:
+ *    simavr -m atmega328p -f 16000000 build/BenchmarkAvrCycles.ino.elf
+ *    simavr prints the serial output of the sketch to the console.
+ *
+ * The edges are fed into the interrupt handler with the pin level and time
+ * stamp, that the IO pin interrupt would pass. So the counts cover the
+ * decoder, but not the reading of micros() and of the IO pin.
+ */
+
+#include "RcSwitchReceiver.hpp"
+#include <Arduino.h>
+
+#if defined(ENABLE_RCSWITCH_TEST) && defined(__AVR__)
+
+#include "test/RcSwitch_cycleBenchmark.hpp"
+#include "test/RandomPulseSource.hpp"
+#include "test/TestFixtures.hpp"
+
+using RcSwitch::rcSwitchProtocolTable;
+using RcSwitch::pt2262ProtocolTable;
+
+// A PT2262 message packet with value 0x13, as recorded with example sketch
+// TraceReceivedPulses.ino. The durations are in usec. The first pulse is a
+// hi pulse, so the pin level is 0 after it has ended. You can paste your own
+// recording here.
+static const uint16_t recordedPulses[] PROGMEM = {
+	  347, 10824,   350,  1066,   328,  1029,   359,  1031,   348,  1062,
+	  328,  1057,   338,  1027,   330,  1052,   351,  1029,   340,  1030,
+	  360,  1052,   328,  1061,   332,  1039,   365,  1065,   362,  1028,
+	  361,  1062,   350,  1028,   339,  1027,   360,  1033,   343,  1051,
+	 1034,   359,   332,  1061,   344,  1060,  1068,   336,  1031,   362,
+};
+
+// Number of edges of generated pulses per protocol table.
+constexpr size_t GENERATED_EDGES_COUNT = 4000;
+// Number of times that the recording is repeated.
+constexpr size_t RECORDED_CYCLES_COUNT = 40;
+
+static RcSwitch::RcSwitch_cycleBenchmark cycleBenchmark;
+
+#endif
+
+// Reference to the serial to be used for printing.
+typeof(Serial)& output = Serial;
+
+// The setup function is called once at startup of the sketch
+void setup()
+{
+	output.begin(115200);
+	output.println("\n>>>>>>>> BenchmarkAvrCycles <<<<<<<<\n");
+
+#if defined(ENABLE_RCSWITCH_TEST) && defined(__AVR__)
+	output.println("CPU cycles per handleInterrupt() call by receiver state:");
+	{
+		RcSwitch::RandomPulseSource pulseSource(rcSwitchProtocolTable.toTimingSpecTable(), 4711);
+		cycleBenchmark.run(rcSwitchProtocolTable.toTimingSpecTable(), pulseSource, GENERATED_EDGES_COUNT);
+		cycleBenchmark.dump(output, "generated rcswitch");
+	}
+	{
+		RcSwitch::RandomPulseSource pulseSource(pt2262ProtocolTable.toTimingSpecTable(), 4711);
+		cycleBenchmark.run(pt2262ProtocolTable.toTimingSpecTable(), pulseSource, GENERATED_EDGES_COUNT);
+		cycleBenchmark.dump(output, "generated pt2262");
+	}
+	{
+		RcSwitch::RecordedPulseSource pulseSource(recordedPulses,
+				sizeof(recordedPulses) / sizeof(recordedPulses[0]), 0, RECORDED_CYCLES_COUNT);
+		cycleBenchmark.run(rcSwitchProtocolTable.toTimingSpecTable(), pulseSource, SIZE_MAX);
+		cycleBenchmark.dump(output, "recorded rcswitch");
+	}
+	{
+		RcSwitch::RecordedPulseSource pulseSource(recordedPulses,
+				sizeof(recordedPulses) / sizeof(recordedPulses[0]), 0, RECORDED_CYCLES_COUNT);
+		cycleBenchmark.run(pt2262ProtocolTable.toTimingSpecTable(), pulseSource, SIZE_MAX);
+		cycleBenchmark.dump(output, "recorded pt2262");
+	}
+	output.println("Done.");
+#else
+	output.println("This sketch requires an AVR micro controller and the compiler option -DENABLE_RCSWITCH_TEST.");
+#endif
+}
+
+// The loop function is called in an endless loop
+void loop()
+{
+}
@@ -0,0 +1,16 @@
+#ifdef __IN_ECLIPSE__
+//This is a automatic generated file
+//Please do not modify this file
+//If you touch this file your change will be overwritten during the next build
+//This file has been generated on 2026-10-18 10:12:41
+
+#include "Arduino.h"
+#include "RcSwitchReceiver.hpp"
+#include <Arduino.h>
+
+void setup() ;
+void loop() ;
+
+#include "BenchmarkAvrCycles.ino"
+
+#endif
@@ -0,0 +1,404 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_PIPELINE_API_HPP_
+#define RCSWITCH_PIPELINE_API_HPP_
+
+#include "internal/ISR_ATTR.hpp"
+#include "internal/RcSwitch.hpp"
+#include "internal/MultiChannelReceiver.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <Arduino.h>
+
+/*
+ * A receive pipeline is composed of stages at compile time:
+ *
+ *   edge source -> glitch filter -> decoder -> repeat confirmer -> mapper -> sink
+ *
+ * Each stage is a class template, whose last template parameter is the type
+ * of the next stage. A stage owns its next stage and calls it directly, so
+ * the compiler can inline the calls between the stages. Stages can be
+ * omitted, e.g. the decoder can pass its packets directly to a sink.
+ *
+ * The decoder stage only instantiates the decoding core. It doesn't have
+ * the optional features of a Receiver, like the band monitor or the packet
+ * quality, so the edges don't pass any checks for them.
+ *
+ * The stages exchange
+ * - edges:   void onEdge(const int pinLevel, const uint32_t usecEdge)
+ *            void flush(), at the end of the input. It passes held back
+ *            edges on.
+ * - packets: void onPacket(const RcSwitch::PipelinePacket& packet)
+ * - buttons: void onButton(const int buttonCode, const RcSwitch::PipelinePacket& packet)
+ * and pass the call void begin(const RxTimingSpecTable&) on to the next
+ * stage. A user defined class with these member functions can be used as
+ * stage, too.
+ *
+ * The edge source determines where the pipeline runs. PinEdgeSource runs
+ * it within the IO pin interrupt handler of the board. BufferEdgeSource
+ * runs it on recorded edges, e.g. from a capture file on a host. The other
+ * stages stay the same.
+ *
+ * Usage example:
+ *
+ * struct MyButtons {
+ *     static int map(const unsigned int, const RcSwitch::receivedValue_t value) {
+ *         switch(value) {
+ *             case 5592332: return 'A';
+ *             case 5592512: return 'B';
+ *         }
+ *         return RcSwitch::NO_BUTTON;
+ *     }
+ * };
+ *
+ * struct MyHandler {
+ *     static volatile int lastButton;
+ *     static void onButton(const int buttonCode, const RcSwitch::PipelinePacket&) {
+ *         lastButton = buttonCode;
+ *     }
+ * };
+ *
+ * using MyStages =
+ *     RcSwitch::GlitchFilter<80,
+ *     RcSwitch::Decoder<
+ *     RcSwitch::RepeatConfirmer<2, 250000,
+ *     RcSwitch::Mapper<MyButtons,
+ *     RcSwitch::Sink<MyHandler>>>>>;
+ *
+ * static RcSwitch::PinEdgeSource<RX433_DATA_PIN, MyStages> pipeline;
+ *
+ * void setup() {
+ *     pipeline.begin(rxProtocolTable.toTimingSpecTable());
+ * }
+ *
+ * On a board, all stages run within interrupt context. So the sink should
+ * only store the result for the loop function.
+ */
+
+namespace RcSwitch {
+
+/** A pin level change at the given time. */
+struct PipelineEdge {
+	uint32_t mUsec;
+	uint8_t mPinLevel;
+};
+
+/**
+ * A received message packet. mUsecTime is the time of the edge, that
+ * completed the packet.
+ */
+struct PipelinePacket {
+	uint32_t mUsecTime;
+	receivedValue_t mValues[RCSWITCH_UINT32_ARRAY_SIZE];
+	size_t mValuesCount;
+	/** Number of received data bits, including the dropped ones. */
+	size_t mBitsCount;
+	/** Matching protocol numbers, in the order of the Receiver. */
+	unsigned int mProtocolNumbers[MAX_PROTOCOL_CANDIDATES];
+	size_t mProtocolCount;
+
+	inline receivedValue_t value() const {return mValues[0];}
+
+	/** Returns true, if the packets carry the same data of the same protocols. */
+	bool isRepeatOf(const PipelinePacket& other) const {
+		if(mBitsCount != other.mBitsCount || mValuesCount != other.mValuesCount
+				|| mProtocolCount != other.mProtocolCount) {
+			return false;
+		}
+		for(size_t i = 0; i < mValuesCount; i++) {
+			if(mValues[i] != other.mValues[i]) {
+				return false;
+			}
+		}
+		for(size_t i = 0; i < mProtocolCount; i++) {
+			if(mProtocolNumbers[i] != other.mProtocolNumbers[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+/** Returned by a button map for values, that are not a button. */
+constexpr int NO_BUTTON = -1;
+
+/**
+ * Edge source, that feeds the edges of an IO pin from within its interrupt
+ * handler. The pipeline has static storage, like the receiver of
+ * RcSwitchReceiver.
+ */
+template<int IOPIN, typename NEXT>
+class PinEdgeSource {
+	static NEXT mNext;
+
+	TEXT_ISR_ATTR_0 static void handleInterrupt() {
+		const unsigned long time = micros();
+		const int pinLevel = digitalRead(IOPIN);
+		mNext.onEdge(pinLevel, time);
+	}
+public:
+	/**
+	 * Start all stages with the given protocol table and start receiving
+	 * interrupts from the IO pin.
+	 */
+	static void begin(const RxTimingSpecTable& rxTimingSpecTable) {
+		mNext.begin(rxTimingSpecTable);
+		pinMode(IOPIN, INPUT_PULLUP);
+		attachInterrupt(digitalPinToInterrupt(IOPIN), handleInterrupt, CHANGE);
+	}
+
+	static NEXT& next() {return mNext;}
+};
+
+template<int IOPIN, typename NEXT> NEXT PinEdgeSource<IOPIN, NEXT>::mNext;
+
+/**
+ * Edge source, that feeds given edges, e.g. edges that have been recorded
+ * on a board or loaded from a capture file on a host.
+ */
+template<typename NEXT>
+class BufferEdgeSource {
+	NEXT mNext;
+public:
+	void begin(const RxTimingSpecTable& rxTimingSpecTable) {
+		mNext.begin(rxTimingSpecTable);
+	}
+
+	inline void onEdge(const int pinLevel, const uint32_t usecEdge) {
+		mNext.onEdge(pinLevel, usecEdge);
+	}
+
+	inline void flush() {
+		mNext.flush();
+	}
+
+	/**
+	 * Feed a complete input. The edges, that the stages hold back, are
+	 * flushed at the end. Input, that arrives in pieces, is fed with
+	 * onEdge() and finished with flush().
+	 */
+	void feed(const PipelineEdge* edges, const size_t count) {
+		for(size_t i = 0; i < count; i++) {
+			mNext.onEdge(edges[i].mPinLevel, edges[i].mUsec);
+		}
+		mNext.flush();
+	}
+
+	NEXT& next() {return mNext;}
+};
+
+/**
+ * Removes pulses, that are shorter than USEC_MIN_PULSE. Such a pulse and
+ * the pulse before it are merged with the pulse after it. Each edge is held
+ * back until the next edge proves, that it did not start a glitch. So the
+ * edges are passed on with a delay of one edge. flush() passes the held
+ * back edge on at the end of the input.
+ */
+template<uint32_t USEC_MIN_PULSE, typename NEXT>
+class GlitchFilter {
+	NEXT mNext;
+	uint32_t mUsecPendingEdge;
+	uint8_t mPendingPinLevel;
+	bool mbEdgePending;
+public:
+	GlitchFilter() : mUsecPendingEdge(0), mPendingPinLevel(0), mbEdgePending(false) {}
+
+	void begin(const RxTimingSpecTable& rxTimingSpecTable) {
+		mbEdgePending = false;
+		mNext.begin(rxTimingSpecTable);
+	}
+
+	TEXT_ISR_ATTR_1_INLINE void onEdge(const int pinLevel, const uint32_t usecEdge) {
+		if(mbEdgePending) {
+			if(usecEdge - mUsecPendingEdge < USEC_MIN_PULSE) {
+				/* The pending edge started a glitch, that ends with this edge. */
+				mbEdgePending = false;
+				return;
+			}
+			mNext.onEdge(mPendingPinLevel, mUsecPendingEdge);
+		}
+		mUsecPendingEdge = usecEdge;
+		mPendingPinLevel = pinLevel;
+		mbEdgePending = true;
+	}
+
+	void flush() {
+		if(mbEdgePending) {
+			mbEdgePending = false;
+			mNext.onEdge(mPendingPinLevel, mUsecPendingEdge);
+		}
+		mNext.flush();
+	}
+
+	NEXT& next() {return mNext;}
+};
+
+/**
+ * Decodes edges into packets. Only the decoding core is instantiated: a
+ * single channel of a MultiChannelReceiver, whose decoding is identical to
+ * the one of class Receiver. The packet is passed on immediately and the
+ * decoding continues, as if resetAvailable() had been called.
+ */
+template<typename NEXT>
+class Decoder : private MultiChannelPacketSink {
+	NEXT mNext;
+	MultiChannelReceiver<1> mDecodingCore;
+	PipelinePacket mPacket;
+	uint32_t mUsecEdge;
+
+	TEXT_ISR_ATTR_1 void onPacket(const size_t, const MultiChannelPacket& packet) override {
+		mPacket.mUsecTime = mUsecEdge;
+		mPacket.mBitsCount = packet.mBitsCount;
+		mPacket.mValuesCount = packet.mValuesCount;
+		for(size_t i = 0; i < RCSWITCH_UINT32_ARRAY_SIZE; i++) {
+			mPacket.mValues[i] = packet.mValues[i];
+		}
+		mPacket.mProtocolCount = packet.mProtocolCount;
+		for(size_t i = 0; i < mPacket.mProtocolCount; i++) {
+			mPacket.mProtocolNumbers[i] = packet.receivedProtocol(i);
+		}
+		mNext.onPacket(mPacket);
+	}
+public:
+	Decoder() : mUsecEdge(0) {
+		mDecodingCore.setPacketSink(this);
+	}
+
+	void begin(const RxTimingSpecTable& rxTimingSpecTable) {
+		mDecodingCore = MultiChannelReceiver<1>();
+		mDecodingCore.setRxTimingSpecTable(rxTimingSpecTable);
+		mDecodingCore.setPacketSink(this);
+		mNext.begin(rxTimingSpecTable);
+	}
+
+	TEXT_ISR_ATTR_1_INLINE void onEdge(const int pinLevel, const uint32_t usecEdge) {
+		mUsecEdge = usecEdge;
+		mDecodingCore.handleEdge(0, pinLevel, usecEdge);
+	}
+
+	/**
+	 * Nothing is held back. A packet is only completed by the synch pulse
+	 * of its repeat.
+	 */
+	void flush() {}
+
+	NEXT& next() {return mNext;}
+};
+
+/**
+ * Passes a packet on, when it has been received REPEATS times in a row.
+ * Further repeats are dropped. A packet counts as repeat, if it arrives
+ * within USEC_RELEASE after the previous one. So a remote control button,
+ * that is kept pressed, is passed on once. After it has been released for
+ * USEC_RELEASE, it is passed on again.
+ */
+template<size_t REPEATS, uint32_t USEC_RELEASE, typename NEXT>
+class RepeatConfirmer {
+	static_assert(REPEATS > 0, "Error: REPEATS must be at least 1.");
+	NEXT mNext;
+	PipelinePacket mLastPacket;
+	size_t mRepeatsCount;
+public:
+	RepeatConfirmer() : mRepeatsCount(0) {}
+
+	void begin(const RxTimingSpecTable& rxTimingSpecTable) {
+		mRepeatsCount = 0;
+		mNext.begin(rxTimingSpecTable);
+	}
+
+	TEXT_ISR_ATTR_1_INLINE void onPacket(const PipelinePacket& packet) {
+		if(mRepeatsCount && packet.mUsecTime - mLastPacket.mUsecTime < USEC_RELEASE
+				&& packet.isRepeatOf(mLastPacket)) {
+			if(mRepeatsCount < REPEATS) {
+				++mRepeatsCount;
+			} else {
+				/* Already passed on. */
+				mLastPacket.mUsecTime = packet.mUsecTime;
+				return;
+			}
+		} else {
+			mRepeatsCount = 1;
+		}
+		mLastPacket = packet;
+		if(mRepeatsCount == REPEATS) {
+			mNext.onPacket(packet);
+		}
+	}
+
+	NEXT& next() {return mNext;}
+};
+
+/**
+ * Maps packets to button codes with the static function
+ * int MAP::map(const unsigned int protocolNumber, const receivedValue_t value).
+ * The matching protocols are tried in order, until one of them yields a
+ * button code other than NO_BUTTON. Packets without button code are dropped.
+ */
+template<typename MAP, typename NEXT>
+class Mapper {
+	NEXT mNext;
+public:
+	void begin(const RxTimingSpecTable& rxTimingSpecTable) {
+		mNext.begin(rxTimingSpecTable);
+	}
+
+	TEXT_ISR_ATTR_1_INLINE void onPacket(const PipelinePacket& packet) {
+		for(size_t i = 0; i < packet.mProtocolCount; i++) {
+			const int buttonCode = MAP::map(packet.mProtocolNumbers[i], packet.value());
+			if(buttonCode != NO_BUTTON) {
+				mNext.onButton(buttonCode, packet);
+				return;
+			}
+		}
+	}
+
+	NEXT& next() {return mNext;}
+};
+
+/**
+ * The end of a pipeline. Calls the static functions HANDLER::onPacket()
+ * respectively HANDLER::onButton(). HANDLER only needs to provide the
+ * function, that the previous stage calls.
+ */
+template<typename HANDLER>
+class Sink {
+public:
+	void begin(const RxTimingSpecTable&) {}
+
+	TEXT_ISR_ATTR_1_INLINE void onPacket(const PipelinePacket& packet) {
+		HANDLER::onPacket(packet);
+	}
+
+	TEXT_ISR_ATTR_1_INLINE void onButton(const int buttonCode, const PipelinePacket& packet) {
+		HANDLER::onButton(buttonCode, packet);
+	}
+};
+
+} // namespace RcSwitch
+
+#endif /* RCSWITCH_PIPELINE_API_HPP_ */
@@ -116,7 +116,8 @@ template<
   unsigned int synchA,  unsigned int synchB,  /* Number of clocks for the synchronization pulse pair. */
   unsigned int data0_A, unsigned int data0_B, /* Number of clocks for a logical 0 bit data pulse pair. */
   unsigned int data1_A, unsigned int data1_B, /* Number of clocks for a logical 1 bit data pulse pair. */
-  bool inverseLevel>                          /* Flag whether pulse levels are normal or inverse. */
+  bool inverseLevel,                          /* Flag whether pulse levels are normal or inverse. */
+  typename packetValidation>                  /* Optional packet validation policy. Refer to PacketValidation.hpp. */
 struct makeTimingSpec;
 
 /**
@@ -153,6 +154,7 @@ struct makeTimingSpec;
  */
 template<typename ...TimingSpecs> struct RxProtocolTable;
 #include "internal/ProtocolTimingSpec.hpp"
+#include "internal/PacketValidation.hpp"
 
 using RcSwitch::RxTimingSpecTable;
 
@@ -199,6 +201,134 @@ public:
 		attachInterrupt(digitalPinToInterrupt(IOPIN), handleInterrupt, CHANGE);
 	}
 
+	/**
+	 * Deliver received message packets through a packet stream. Data bits
+	 * are emitted as 32 bit data words as soon as they have been received,
+	 * framed by packet start and end markers. Hence message packets with
+	 * more than MAX_MSG_PACKET_BITS can be received.
+	 * In streaming mode, available() never returns true. Every repetition
+	 * of a message packet is delivered through the stream.
+	 * Must be called before begin().
+	 *
+	 * Example:
+	 *
+	 * static RcSwitch::PacketStream<16> packetStream;
+	 * ...
+	 * rcSwitchReceiver.setPacketStream(packetStream);
+	 * rcSwitchReceiver.begin(rxProtocolTable.toTimingSpecTable());
+	 * ...
+	 * RcSwitch::PacketStreamItem item;
+	 * while(packetStream.read(item)) {
+	 *   switch(item.mType) {
+	 *     case RcSwitch::STREAM_ITEM_TYPE::PACKET_START: ... break;
+	 *     case RcSwitch::STREAM_ITEM_TYPE::DATA_WORD:    ... break;
+	 *     case RcSwitch::STREAM_ITEM_TYPE::PACKET_END:   ... break;
+	 *     case RcSwitch::STREAM_ITEM_TYPE::PACKET_ABORT: ... break;
+	 *   }
+	 * }
+	 */
+	static void setPacketStream(RcSwitch::PacketStreamBase& packetStream) {
+		mReceiverDelegate.setPacketStream(&packetStream);
+	}
+
+	/**
+	 * Learn the pulse timing of the transmitters, that are actually
+	 * received, and narrow the time ranges of the protocol table towards
+	 * it. The receiver must be started with the RAM shadow table of the
+	 * timing tuner. Must be called before begin().
+	 *
+	 * Example:
+	 *
+	 * static RcSwitch::TimingTuner<decltype(rxProtocolTable)::ROW_COUNT> timingTuner(
+	 *     rxProtocolTable.toTimingSpecTable());
+	 * ...
+	 * rcSwitchReceiver.setTimingTuner(timingTuner);
+	 * rcSwitchReceiver.begin(timingTuner.toTimingSpecTable());
+	 */
+	static void setTimingTuner(RcSwitch::TimingTunerBase& timingTuner) {
+		mReceiverDelegate.setTimingTuner(&timingTuner);
+	}
+
+	/**
+	 * Narrow the time ranges of the timing tuner's shadow table towards
+	 * the pulse timing observed so far. Call it from the loop, after the
+	 * received value has been processed and resetAvailable() has been
+	 * called. Returns true, if the time ranges have been updated.
+	 */
+	static bool tuneTimingSpec() {return mReceiverDelegate.tuneTimingSpec();}
+
+	/**
+	 * Collect signal quality metrics of the received message packet in the
+	 * given object: The measured protocol clock, the maximum deviation of a
+	 * data pulse from its nominal duration, the tightest margin of a data
+	 * pulse to its time range bounds and the number of repeats seen. The
+	 * metrics are valid while available() returns true. Without a packet
+	 * quality object, the interrupt handler doesn't measure the data pulses.
+	 * Must be called before begin().
+	 *
+	 * Example:
+	 *
+	 * static RcSwitch::PacketQuality packetQuality;
+	 * ...
+	 * rcSwitchReceiver.setPacketQuality(packetQuality);
+	 * rcSwitchReceiver.begin(rxProtocolTable.toTimingSpecTable());
+	 * ...
+	 * if(rcSwitchReceiver.available()) {
+	 *   Serial.print(packetQuality.usecMeasuredClock());
+	 *   Serial.print(packetQuality.percentMaxDeviation());
+	 *   Serial.print(packetQuality.percentMinMargin());
+	 *   Serial.print(packetQuality.repeats());
+	 * }
+	 */
+	static void setPacketQuality(RcSwitch::PacketQuality& packetQuality) {
+		mReceiverDelegate.setPacketQuality(&packetQuality);
+	}
+
+	/**
+	 * Account every received edge in the given band monitor, independent
+	 * of the decoding success. That adds a histogram increment to the
+	 * interrupt handler for every edge, refer to class BandMonitor. Must be
+	 * called before begin().
+	 *
+	 * Example:
+	 *
+	 * static RcSwitch::BandMonitor bandMonitor;
+	 * ...
+	 * rcSwitchReceiver.setBandMonitor(bandMonitor);
+	 * rcSwitchReceiver.begin(rxProtocolTable.toTimingSpecTable());
+	 * ...
+	 * RcSwitch::BandSnapshot snapshot;
+	 * bandMonitor.snapshot(snapshot);
+	 * snapshot.dump(Serial, "");
+	 */
+	static void setBandMonitor(RcSwitch::BandMonitor& bandMonitor) {
+		mReceiverDelegate.setBandMonitor(&bandMonitor);
+	}
+
+	/**
+	 * Learn interval and phase of periodic transmitters and decode only
+	 * within the expected reception windows, as soon as all transmitters
+	 * heard are locked. Edges between the windows are dropped, except
+	 * within the periodic discovery windows. Must be called before begin().
+	 *
+	 * Transmitters are told apart by the protocol number and the id bits
+	 * of the first received value. With a packet stream set, the data bits
+	 * aren't stored, so the id is always 0. Then all transmitters of the
+	 * same protocol merge into one source, whose bursts don't follow a
+	 * single interval. Such a source never locks, and the receiver
+	 * decodes all of the time.
+	 *
+	 * Example:
+	 *
+	 * static RcSwitch::ReceptionScheduler<8> receptionScheduler;
+	 * ...
+	 * rcSwitchReceiver.setReceptionScheduler(receptionScheduler);
+	 * rcSwitchReceiver.begin(rxProtocolTable.toTimingSpecTable());
+	 */
+	static void setReceptionScheduler(RcSwitch::ReceptionSchedulerBase& receptionScheduler) {
+		mReceiverDelegate.setReceptionScheduler(&receptionScheduler);
+	}
+
 	/**
 	 * Returns true, when a new received value is available.
 	 * Can be called at any time.
@@ -306,6 +436,30 @@ public:
 		RcSwitch::ReceiverSelector<PULSE_TRACES_COUNT>::dumpPulseTracer(mReceiverDelegate, serial, separator);
 	}
 
+	/**
+	 * Trace the received pulses into a pulse tracer, that is shared with
+	 * other receivers. Requires template parameter PULSE_TRACES_COUNT to be
+	 * RcSwitch::SHARED_PULSE_TRACER. Each receiver needs a distinct sourceId
+	 * within range 0 .. RcSwitch::MAX_TRACE_SOURCE_ID. dumpPulseTracer()
+	 * and deduceProtocolFromPulseTracer() only evaluate the pulses of this
+	 * receiver. Returns false and doesn't attach the pulse tracer, if the
+	 * sourceId is out of range.
+	 *
+	 * Example:
+	 *
+	 * static RcSwitch::SharedPulseTracer<140> pulseTracer;
+	 * static RcSwitchReceiver<5, RcSwitch::SHARED_PULSE_TRACER> rcSwitchReceiver433;
+	 * static RcSwitchReceiver<6, RcSwitch::SHARED_PULSE_TRACER> rcSwitchReceiver315;
+	 * ...
+	 * rcSwitchReceiver433.attachPulseTracer(pulseTracer, 0);
+	 * rcSwitchReceiver315.attachPulseTracer(pulseTracer, 1);
+	 */
+	static bool attachPulseTracer(RcSwitch::SharedPulseTracerBase& pulseTracer, const uint8_t sourceId) {
+		static_assert(PULSE_TRACES_COUNT == RcSwitch::SHARED_PULSE_TRACER,
+				"Error: attachPulseTracer() requires PULSE_TRACES_COUNT to be RcSwitch::SHARED_PULSE_TRACER.");
+		return mReceiverDelegate.attachPulseTracer(&pulseTracer, sourceId);
+	}
+
 	/**
 	 * Deduce protocol and dump the result on the serial monitor.
 	 */
@@ -313,6 +467,17 @@ public:
 		RcSwitch::ReceiverSelector<PULSE_TRACES_COUNT>::deduceProtocolFromPulseTracer(mReceiverDelegate, serial);
 	}
 
+	/**
+	 * Print the decoder events, that have been recorded since the last call.
+	 * At most maxCount events are printed per call, so that this function
+	 * can be called from the loop without blocking it for long. Printing
+	 * stops early, when the serial transmit buffer is nearly full.
+	 * Requires RCSWITCH_EVENT_LOG_SIZE to be defined greater than 0.
+	 */
+	static size_t dumpDecoderEvents(typeof(Serial)& serial, const size_t maxCount = 8) {
+		return mReceiverDelegate.dumpDecoderEvents(serial, maxCount);
+	}
+
 	/**
 	 * Return a reference to the internal receiver that this API class forwards
 	 * it's public function calls to.
@@ -324,7 +489,8 @@ private:
 	static constexpr bool IS_SMALL_PROCESSOR = sizeof(size_t) <= 2;
 	static constexpr size_t PULSE_TRACES_LIMIT = IS_SMALL_PROCESSOR ? 140 : 280;
 
-	static_assert((PULSE_TRACES_COUNT <= PULSE_TRACES_LIMIT),
+	static_assert((PULSE_TRACES_COUNT <= PULSE_TRACES_LIMIT)
+			|| (PULSE_TRACES_COUNT == RcSwitch::SHARED_PULSE_TRACER),
 			"Error: Maximum number for parameter PULSE_TRACES_COUNT exceeded. "
 			"The need for static RAM scales with the number of traced pulses "
 			"and the likelihood of a stack overflow scales with the consumption "
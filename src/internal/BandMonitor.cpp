@@ -0,0 +1,101 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#include <Arduino.h>
+#include "BandMonitor.hpp"
+#include "RcSwitch.hpp"
+#include "FormattedPrint.hpp"
+
+namespace RcSwitch {
+
+void BandMonitor::snapshot(BandSnapshot& snapshot) {
+	const uint32_t usecNow = micros_();
+	snapshot.mEdgesCount = 0;
+	snapshot.mUsecActive = 0;
+	for(size_t level = 0; level < BAND_PULSE_LEVELS_COUNT; level++) {
+		for(size_t bin = 0; bin < BAND_HISTOGRAM_BINS; bin++) {
+			noInterrupts();
+			const uint16_t count = mBins[level][bin];
+			mBins[level][bin] = 0;
+			interrupts();
+
+			snapshot.mBins[level][bin] = count;
+			snapshot.mEdgesCount += count;
+			/* The last bin is open ended. It never counts as activity. */
+			if(bin < BAND_HISTOGRAM_BINS - 1
+					&& BandSnapshot::usecBinLowerBound(bin + 1) <= mUsecIdleThreshold) {
+				const uint32_t usecBinMiddle = (BandSnapshot::usecBinLowerBound(bin)
+						+ BandSnapshot::usecBinLowerBound(bin + 1)) / 2;
+				snapshot.mUsecActive += count * usecBinMiddle;
+			}
+		}
+	}
+	snapshot.mUsecInterval = usecNow - mUsecLastSnapshot;
+	mUsecLastSnapshot = usecNow;
+
+	const uint32_t edgesPerSecond = snapshot.edgesPerSecond();
+	if(edgesPerSecond > mPeakEdgesPerSecond) {
+		mPeakEdgesPerSecond = edgesPerSecond;
+	}
+	snapshot.mPeakEdgesPerSecond = mPeakEdgesPerSecond;
+}
+
+void BandMonitor::reset() {
+	for(size_t level = 0; level < BAND_PULSE_LEVELS_COUNT; level++) {
+		for(size_t bin = 0; bin < BAND_HISTOGRAM_BINS; bin++) {
+			mBins[level][bin] = 0;
+		}
+	}
+	mUsecLastSnapshot = micros_();
+	mPeakEdgesPerSecond = 0;
+}
+
+template<> void BandSnapshot::dump(typeof(Serial)& serial, const char* separator) const {
+	serial.print("Edges: ");
+	serial.print(mEdgesCount);
+	serial.print(" within ");
+	serial.print(mUsecInterval);
+	serial.print("usec, activity: ");
+	serial.print(percentActivity());
+	serial.print("%, edges per second: ");
+	serial.print(edgesPerSecond());
+	serial.print(", peak: ");
+	serial.println(mPeakEdgesPerSecond);
+
+	serial.println("Pulse durations   LO pulses   HI pulses");
+	for(size_t bin = 0; bin < BAND_HISTOGRAM_BINS; bin++) {
+		if(mBins[BAND_LO_PULSES][bin] == 0 && mBins[BAND_HI_PULSES][bin] == 0) {
+			continue;
+		}
+		serial.print(">=");
+		serial.print(separator);
+		printUsecWithSeparator(serial, usecBinLowerBound(bin), 5, separator);
+		serial.print(mBins[BAND_LO_PULSES][bin]);
+		serial.print(separator && strlen(separator) ? separator : "\t");
+		serial.println(mBins[BAND_HI_PULSES][bin]);
+	}
+}
+
+} // namespace RcSwitch
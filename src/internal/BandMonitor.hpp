@@ -0,0 +1,199 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_INTERNAL_BANDMONITOR_HPP_
+#define RCSWITCH_RECEIVER_INTERNAL_BANDMONITOR_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ISR_ATTR.hpp"
+
+namespace RcSwitch {
+
+/**
+ * Number of histogram bins per pulse level. Bin 0 holds pulses of 0usec.
+ * Bin i holds pulses of [2^(i-1) .. 2^i[ usec. The last bin holds all
+ * longer pulses.
+ */
+static constexpr size_t BAND_HISTOGRAM_BINS = 17;
+
+/** Histogram rows. */
+enum BAND_PULSE_LEVEL : uint8_t {
+	BAND_LO_PULSES = 0,
+	BAND_HI_PULSES,
+	BAND_PULSE_LEVELS_COUNT,
+};
+
+/**
+ * The band monitor statistics of the interval since the previous snapshot.
+ */
+struct BandSnapshot {
+	uint16_t mBins[BAND_PULSE_LEVELS_COUNT][BAND_HISTOGRAM_BINS];
+
+	/** Number of edges within the interval. */
+	uint32_t mEdgesCount;
+
+	/** Length of the interval. */
+	uint32_t mUsecInterval;
+
+	/**
+	 * Time covered by pulses shorter than the idle threshold. It is
+	 * estimated from the histogram, with every pulse at the middle of its
+	 * bin.
+	 */
+	uint32_t mUsecActive;
+
+	/** The highest edge rate of all intervals since the last reset. */
+	uint32_t mPeakEdgesPerSecond;
+
+	/** The shortest pulse duration of the bin. */
+	static uint32_t usecBinLowerBound(const size_t bin) {
+		return bin ? static_cast<uint32_t>(1) << (bin - 1) : 0;
+	}
+
+	/** The fraction of time with edge activity in percent. */
+	unsigned percentActivity() const {
+		if(mUsecInterval) {
+			const uint64_t percent = (static_cast<uint64_t>(mUsecActive) * 100) / mUsecInterval;
+			return percent < 100 ? percent : 100;
+		}
+		return 0;
+	}
+
+	/** The edge rate within the interval. */
+	uint32_t edgesPerSecond() const {
+		if(mUsecInterval) {
+			return (static_cast<uint64_t>(mEdgesCount) * 1000000) / mUsecInterval;
+		}
+		return 0;
+	}
+
+	template <typename T> void dump(T& serial, const char* separator) const;
+};
+
+/**
+ * Watches the band independent of the decoding success. The receiver feeds
+ * every edge into the band monitor, even while it is suspended or a
+ * received packet is available. The interrupt handler only increments a
+ * bin of a log2 scale histogram of the pulse durations per pulse level.
+ * snapshot() derives from the histogram
+ * - the number of edges and the edge rate,
+ * - the fraction of time with edge activity. Pulses shorter than the idle
+ *   threshold count as activity, longer ones as a quiet band,
+ * - the highest edge rate of all snapshot intervals.
+ *
+ * That tells where glitch filters and tolerances should sit. The monitor
+ * does not use any pulse tracer RAM.
+ *
+ * The bins have 16 bits. snapshot() must be called, before a bin has
+ * counted 65535 pulses. Calling it once per second is sufficient for any
+ * realistic noise level.
+ *
+ * Usage example:
+ *
+ * static RcSwitch::BandMonitor bandMonitor;
+ * ...
+ * rcSwitchReceiver.setBandMonitor(bandMonitor);
+ * rcSwitchReceiver.begin(rxProtocolTable.toTimingSpecTable());
+ * ...
+ * RcSwitch::BandSnapshot snapshot;
+ * bandMonitor.snapshot(snapshot);
+ * snapshot.dump(Serial, "");
+ */
+class BandMonitor {
+	/** Written by the interrupt handler. Read and cleared by snapshot(). */
+	volatile uint16_t mBins[BAND_PULSE_LEVELS_COUNT][BAND_HISTOGRAM_BINS];
+
+	const uint32_t mUsecIdleThreshold;
+	uint32_t mUsecLastSnapshot;
+	uint32_t mPeakEdgesPerSecond;
+
+	/**
+	 * The bin is the number of significant bits. It is narrowed down with
+	 * 8 bit operations, because count leading zeros is a library loop on
+	 * an 8 bit AVR.
+	 */
+	static TEXT_ISR_ATTR_2_INLINE uint8_t binOf(const uint32_t usecDuration) {
+		if(usecDuration >= (static_cast<uint32_t>(1) << (BAND_HISTOGRAM_BINS - 2))) {
+			return BAND_HISTOGRAM_BINS - 1;
+		}
+		uint8_t bin = 0;
+		uint8_t value = static_cast<uint16_t>(usecDuration) >> 8;
+		if(value) {
+			bin = 8;
+		} else {
+			value = static_cast<uint8_t>(usecDuration);
+		}
+		if(value >= 16) {bin += 4; value >>= 4;}
+		if(value >= 4) {bin += 2; value >>= 2;}
+		if(value >= 2) {bin += 1; value >>= 1;}
+		return bin + value;
+	}
+
+public:
+	/**
+	 * Pulses shorter than usecIdleThreshold count as edge activity. The
+	 * threshold is rounded down to a bin boundary.
+	 */
+	BandMonitor(const uint32_t usecIdleThreshold = 20000)
+		: mUsecIdleThreshold(usecIdleThreshold) {
+		reset();
+	}
+
+	/** ========================================================================== */
+	/** ========= Called from within interrupt context =========================== */
+
+	/**
+	 * Account a pulse. pinLevel is the level of the IO pin after the edge,
+	 * that ended the pulse.
+	 */
+	TEXT_ISR_ATTR_1_INLINE void addPulse(const uint32_t usecDuration, const int pinLevel) {
+		/* Pin level LO after the edge means, that a HI pulse ended. */
+		++mBins[pinLevel ? BAND_LO_PULSES : BAND_HI_PULSES][binOf(usecDuration)];
+	}
+
+	/** ========================================================================== */
+	/** ========= Called from the application ==================================== */
+
+	/**
+	 * Provide the statistics of the interval since the previous snapshot
+	 * or reset, and start the next interval. Each bin is read and cleared
+	 * with the interrupts disabled for a few instructions only.
+	 */
+	void snapshot(BandSnapshot& snapshot);
+
+	/**
+	 * Forget all statistics. Must not run concurrently with the interrupt
+	 * handler of the receiver.
+	 */
+	void reset();
+};
+
+} // namespace RcSwitch
+
+#endif /* RCSWITCH_RECEIVER_INTERNAL_BANDMONITOR_HPP_ */
@@ -0,0 +1,236 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_INTERNAL_DECODEREVENTLOG_HPP_
+#define RCSWITCH_RECEIVER_INTERNAL_DECODEREVENTLOG_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ISR_ATTR.hpp"
+#include "FormattedPrint.hpp"
+
+/**
+ * Setting RCSWITCH_EVENT_LOG_SIZE to a power of 2 in the range 2 .. 128
+ * makes the receiver record what it did with the received pulses. 0
+ * disables the event log and removes it completely from the receiver.
+ * Must be defined identically for all compilation units, e.g. as
+ * compiler option -DRCSWITCH_EVENT_LOG_SIZE=64
+ */
+#if not defined RCSWITCH_EVENT_LOG_SIZE
+#define RCSWITCH_EVENT_LOG_SIZE (0)
+#endif
+
+namespace RcSwitch {
+
+enum class DECODER_EVENT : uint8_t {
+	/**
+	 * Synch pulse pair matched. Argument is the protocol candidate mask.
+	 * Refer to DECODER_EVENT_CANDIDATES_OVERFLOW_FLAG.
+	 */
+	SYNCH_MATCHED = 0,
+	/** A protocol candidate did not match. Argument is the protocol index. */
+	CANDIDATE_PRUNED,
+	/** A data bit has been appended. Argument is the data bit. */
+	BIT_APPENDED,
+	/** Packet dropped, pulses matched no candidate. Argument is the bit count. */
+	ABORTED_UNKNOWN_PULSES,
+	/** Packet dropped, too less data bits. Argument is the bit count. */
+	ABORTED_TOO_SHORT,
+	/** Packet published. Argument is the bit count. */
+	PACKET_PUBLISHED,
+	/** An edge has been ignored, because a received packet is pending. */
+	EDGE_DROPPED,
+	/** Packet dropped, no candidate's validation accepted it. Argument is the bit count. */
+	ABORTED_INVALID,
+};
+
+/**
+ * The bit within the candidate mask respectively the protocol index, that
+ * flags an inverse level protocol.
+ */
+constexpr uint8_t DECODER_EVENT_INVERSE_LEVEL_FLAG = 0x80;
+
+/**
+ * The candidate mask holds a bit for each of the protocol indices
+ * 0 .. DECODER_EVENT_MASKED_CANDIDATES - 1. This flag is set within the
+ * candidate mask, if there are candidates with a higher protocol index.
+ */
+constexpr uint8_t DECODER_EVENT_CANDIDATES_OVERFLOW_FLAG = 0x40;
+constexpr size_t DECODER_EVENT_MASKED_CANDIDATES = 6;
+
+/** The longest line, that dump() prints for an event. */
+constexpr int DECODER_EVENT_MAX_LINE_LENGTH = 40;
+
+inline const char* decoderEventToString(const DECODER_EVENT event) {
+	switch(event) {
+	case DECODER_EVENT::SYNCH_MATCHED:
+		return "SYNCH MATCHED   candidates";
+	case DECODER_EVENT::CANDIDATE_PRUNED:
+		return "PRUNED          protocol index";
+	case DECODER_EVENT::BIT_APPENDED:
+		return "BIT             ";
+	case DECODER_EVENT::ABORTED_UNKNOWN_PULSES:
+		return "ABORT UNKNOWN   bits";
+	case DECODER_EVENT::ABORTED_TOO_SHORT:
+		return "ABORT TOO SHORT bits";
+	case DECODER_EVENT::PACKET_PUBLISHED:
+		return "PUBLISHED       bits";
+	case DECODER_EVENT::EDGE_DROPPED:
+		return "EDGE DROPPED    ";
+	case DECODER_EVENT::ABORTED_INVALID:
+		return "ABORT INVALID   bits";
+	}
+	return "??";
+}
+
+struct DecoderEventRecord {
+	DECODER_EVENT mEvent;
+	uint8_t mArgument;
+};
+
+/**
+ * A fixed size ring of decoder events. Writing an event costs an index
+ * comparison, an index increment and a 2 byte store. When the application
+ * doesn't read fast enough, new events are dropped and counted as lost.
+ */
+template<size_t EVENT_LOG_SIZE>
+class DecoderEventLog {
+	friend class RcSwitch_test;
+	static_assert(EVENT_LOG_SIZE >= 2 && EVENT_LOG_SIZE <= 128
+			&& (EVENT_LOG_SIZE & (EVENT_LOG_SIZE - 1)) == 0,
+			"Error: RCSWITCH_EVENT_LOG_SIZE must be a power of 2 within range 2 .. 128.");
+
+	static constexpr uint8_t INDEX_MASK = EVENT_LOG_SIZE - 1;
+
+	DecoderEventRecord mRecords[EVENT_LOG_SIZE];
+
+	/**
+	 * Free running indices. Wrap around at 256. The writer never gets more
+	 * than EVENT_LOG_SIZE ahead of the reader, hence their difference
+	 * doesn't wrap.
+	 */
+	volatile uint8_t mWriteIndex;
+	volatile uint8_t mReadIndex;
+
+	/**
+	 * Free running count of lost events, written by the writer only.
+	 * The reader remembers the count, that it has reported so far. The
+	 * writer stops counting, when 255 events haven't been reported.
+	 */
+	volatile uint8_t mLostCount;
+	uint8_t mReportedLostCount;
+
+public:
+	static constexpr bool ENABLED = true;
+
+	DecoderEventLog() : mWriteIndex(0), mReadIndex(0), mLostCount(0), mReportedLostCount(0) {
+	}
+
+	TEXT_ISR_ATTR_1_INLINE void log(const DECODER_EVENT event, const uint8_t argument) {
+		const uint8_t writeIndex = mWriteIndex;
+		if(static_cast<uint8_t>(writeIndex - mReadIndex) < EVENT_LOG_SIZE) {
+			mRecords[writeIndex & INDEX_MASK] = DecoderEventRecord{event, argument};
+			mWriteIndex = writeIndex + 1;
+		} else {
+			const uint8_t lostCount = mLostCount + 1;
+			if(lostCount != mReportedLostCount) {
+				mLostCount = lostCount;
+			}
+		}
+	}
+
+	/**
+	 * Print at most maxCount events, that haven't been printed so far.
+	 * Printing stops early, when the transmit buffer of the serial can't
+	 * take another line without blocking. Keeps the time spent within the
+	 * application loop bounded. Returns the number of printed events.
+	 */
+	template<typename T> size_t dump(T& serial, const size_t maxCount) {
+		const uint8_t lostCount = mLostCount;
+		if(lostCount != mReportedLostCount) {
+			if(serial.availableForWrite() < DECODER_EVENT_MAX_LINE_LENGTH) {
+				return 0;
+			}
+			const uint8_t unreportedLostCount = lostCount - mReportedLostCount;
+			serial.print("Events lost: ");
+			serial.print(unreportedLostCount);
+			if(unreportedLostCount == UINT8_MAX) {
+				serial.print(" or more");
+			}
+			serial.println();
+			mReportedLostCount = lostCount;
+		}
+		const uint8_t pending = mWriteIndex - mReadIndex;
+		size_t i = 0;
+		for(; i < pending && i < maxCount; i++) {
+			if(serial.availableForWrite() < DECODER_EVENT_MAX_LINE_LENGTH) {
+				break;
+			}
+			const DecoderEventRecord& record = mRecords[mReadIndex & INDEX_MASK];
+			printStringWithSeparator(serial, decoderEventToString(record.mEvent), "");
+			if(record.mEvent == DECODER_EVENT::SYNCH_MATCHED) {
+				serial.print((record.mArgument & DECODER_EVENT_INVERSE_LEVEL_FLAG) ? "inverse 0x" : "normal 0x");
+				serial.print(record.mArgument & ~(DECODER_EVENT_INVERSE_LEVEL_FLAG | DECODER_EVENT_CANDIDATES_OVERFLOW_FLAG), 16);
+				if(record.mArgument & DECODER_EVENT_CANDIDATES_OVERFLOW_FLAG) {
+					serial.print(" and more");
+				}
+			} else if(record.mEvent == DECODER_EVENT::CANDIDATE_PRUNED) {
+				serial.print((record.mArgument & DECODER_EVENT_INVERSE_LEVEL_FLAG) ? "inverse " : "normal ");
+				serial.print(record.mArgument & ~DECODER_EVENT_INVERSE_LEVEL_FLAG);
+			} else if(record.mEvent != DECODER_EVENT::EDGE_DROPPED) {
+				serial.print(record.mArgument);
+			}
+			serial.println();
+			/* Hand the record back to the writer as the last action. */
+			mReadIndex = mReadIndex + 1;
+		}
+		return i;
+	}
+};
+
+/**
+ * Specialization for a disabled event log. Logging is optimized
+ * away. The class is empty, so that it takes no space as a base
+ * class of the receiver.
+ */
+template<> class DecoderEventLog<0> {
+public:
+	static constexpr bool ENABLED = false;
+
+	TEXT_ISR_ATTR_1_INLINE void log(const DECODER_EVENT, const uint8_t) {
+	}
+
+	template<typename T> size_t dump(T& serial, const size_t) {
+		serial.println("The decoder event log is disabled. Define RCSWITCH_EVENT_LOG_SIZE "
+				"to enable it.");
+		return 0;
+	}
+};
+
+} // namespace RcSwitch
+
+#endif /* RCSWITCH_RECEIVER_INTERNAL_DECODEREVENTLOG_HPP_ */
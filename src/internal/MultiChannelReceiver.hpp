@@ -0,0 +1,402 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_INTERNAL_MULTICHANNELRECEIVER_HPP_
+#define RCSWITCH_RECEIVER_INTERNAL_MULTICHANNELRECEIVER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ISR_ATTR.hpp"
+#include "RcSwitch.hpp"
+#include "ProtocolTimingSpec.hpp"
+#include "TypeTraits.hpp"
+
+namespace RcSwitch {
+
+/**
+ * A message packet that has been received by a channel of a
+ * MultiChannelReceiver. The content is identical to what the
+ * Receiver provides through receivedValueAt(), receivedBitsCount()
+ * and receivedProtocol().
+ */
+struct MultiChannelPacket {
+	receivedValue_t mValues[RCSWITCH_UINT32_ARRAY_SIZE];
+	size_t mValuesCount;
+	/** Number of received data bits, including the dropped ones. */
+	size_t mBitsCount;
+	/** Matching protocol numbers, in the order of the Receiver. */
+	unsigned int mProtocolNumbers[MAX_PROTOCOL_CANDIDATES];
+	size_t mProtocolCount;
+
+	int receivedProtocol(const size_t index) const {
+		return index < mProtocolCount ? static_cast<int>(mProtocolNumbers[index]) : -1;
+	}
+};
+
+/**
+ * Receives the message packets of a MultiChannelReceiver.
+ */
+class MultiChannelPacketSink {
+public:
+	/**
+	 * Will be called, when a message packet has been received on the given
+	 * channel. The channel continues to receive after this function returns.
+	 */
+	virtual void onPacket(const size_t channel, const MultiChannelPacket& packet) = 0;
+	virtual ~MultiChannelPacketSink() {}
+};
+
+/**
+ * A decoder for many independent pulse sources, e.g. for host side
+ * deployments that receive from thousands of radio receivers.
+ *
+ * The decoder state of all channels is stored as structure of arrays, so
+ * that the state of neighbor channels shares cache lines. A batch of
+ * channels is advanced in lockstep with one edge per channel: first the
+ * pulse windows of all channels of the batch are updated within a tight
+ * loop, that the compiler can vectorize. Then the channels, whose pulse
+ * window is complete, are analyzed.
+ *
+ * The decoding is identical to the one of class Receiver. Protocol
+ * candidates are stored as bit mask of protocol indices and evaluated
+ * from the highest to the lowest index, like the Receiver evaluates its
+ * candidate stack. Each channel behaves like a Receiver, whose
+ * resetAvailable() is called immediately after a packet became available.
+ * A single channel is the decoding core of the pipeline stage Decoder,
+ * which runs within interrupt context on a board.
+ */
+template<size_t CHANNELS_COUNT>
+class MultiChannelReceiver {
+	using candidateMask_t = uint32_t;
+	static constexpr size_t MAX_PROTOCOLS_PER_GROUP = 8 * sizeof(candidateMask_t);
+	static constexpr size_t VALUE_BITS = 8 * sizeof(receivedValue_t);
+
+	/** Pulse level bits within mPulseLevels. Set means HI level. */
+	static constexpr uint8_t PULSE_B_HI = 0x01;
+	static constexpr uint8_t PULSE_A_HI = 0x02;
+
+	RxTimingSpecTable mRxTimingSpecTables[2];
+	MultiChannelPacketSink* mPacketSink;
+
+	/** ========= Hot state, touched for every edge ========= */
+	uint32_t mUsecLastEdge[CHANNELS_COUNT];
+	/** The pulse window. A is the older, B the newer pulse. */
+	duration_t mPulseDurationA[CHANNELS_COUNT];
+	duration_t mPulseDurationB[CHANNELS_COUNT];
+	uint8_t mPulseLevels[CHANNELS_COUNT];
+	uint8_t mPulseCount[CHANNELS_COUNT];
+	uint8_t mDataPulseCount[CHANNELS_COUNT];
+	candidateMask_t mCandidates[CHANNELS_COUNT];
+
+	/** ========= State touched for completed pulse pairs ========= */
+	uint8_t mProtocolGroup[CHANNELS_COUNT];
+	uint32_t mBitsCount[CHANNELS_COUNT];
+	receivedValue_t mBits[RCSWITCH_UINT32_ARRAY_SIZE][CHANNELS_COUNT];
+
+	static TEXT_ISR_ATTR_2_INLINE bool isWithin(const TimeRange& range, const uint32_t value) {
+		return range.compare(value) == TimeRange::IS_WITHIN;
+	}
+
+	/** Refer to pulseAtoPulseTypes() and pulseBtoPulseTypes(). */
+	static TEXT_ISR_ATTR_2_INLINE PULSE_TYPE dataPulseType(const TimeRange& data0, const TimeRange& data1, const duration_t duration) {
+		if(isWithin(data0, duration)) {
+			return PULSE_TYPE::DATA_LOGICAL_00;
+		}
+		if(isWithin(data1, duration)) {
+			return PULSE_TYPE::DATA_LOGICAL_01;
+		}
+		return PULSE_TYPE::UNKNOWN;
+	}
+
+	TEXT_ISR_ATTR_2_INLINE void collectProtocolCandidates(const size_t c) {
+		const bool levelA_HI = mPulseLevels[c] & PULSE_A_HI;
+		const bool levelB_HI = mPulseLevels[c] & PULSE_B_HI;
+		if(levelA_HI != levelB_HI) {
+			const uint8_t group = levelA_HI ? NORMAL_LEVEL_PROTOCOLS : INVERSE_LEVEL_PROTOCOLS;
+			mProtocolGroup[c] = group;
+			const RxTimingSpecTable& table = mRxTimingSpecTables[group];
+			const duration_t durationA = mPulseDurationA[c];
+			const duration_t durationB = mPulseDurationB[c];
+			candidateMask_t candidates = 0;
+			size_t candidatesCount = 0;
+			for(size_t i = 0; i < table.size; i++) {
+				const RxPulsePairTimeRanges& synch = table.start[i].synchronizationPulsePair;
+				if(durationA < synch.durationA.lowerBound) {
+					/* Protocols are sorted in ascending order of synchronization
+					 * pulse A lower bound. */
+					break;
+				}
+				if(durationA < synch.durationA.upperBound && isWithin(synch.durationB, durationB)) {
+					/* The Receiver drops candidates beyond its stack capacity. */
+					if(candidatesCount < MAX_PROTOCOL_CANDIDATES) {
+						candidates |= static_cast<candidateMask_t>(1) << i;
+						++candidatesCount;
+					}
+				}
+			}
+			mCandidates[c] = candidates;
+		}
+	}
+
+	/**
+	 * Refer to Receiver::analyzePulsePair(). Candidates are evaluated from
+	 * the highest to the lowest protocol index.
+	 */
+	TEXT_ISR_ATTR_2_INLINE PULSE_TYPE analyzePulsePair(const size_t c) {
+		PULSE_TYPE result = PULSE_TYPE::UNKNOWN;
+		const RxTimingSpecTable& table = mRxTimingSpecTables[mProtocolGroup[c]];
+		const duration_t durationA = mPulseDurationA[c];
+		const duration_t durationB = mPulseDurationB[c];
+		candidateMask_t candidates = mCandidates[c];
+		candidateMask_t remaining = candidates;
+		while(remaining) {
+			size_t i = MAX_PROTOCOLS_PER_GROUP - 1;
+			while(not (remaining & (static_cast<candidateMask_t>(1) << i))) {
+				--i;
+			}
+			const candidateMask_t bit = static_cast<candidateMask_t>(1) << i;
+			remaining &= ~bit;
+
+			const RxTimingSpec& protocol = table.start[i];
+			/* TimeRange::TOO_SHORT equals TimeRange::TOO_LONG. Hence the Receiver
+			 * requires the first synch pulse to be within its time range, too. */
+			if(isWithin(protocol.synchronizationPulsePair.durationA, durationA)
+					&& isWithin(protocol.synchronizationPulsePair.durationB, durationB)) {
+				mCandidates[c] = candidates;
+				return PULSE_TYPE::SYCH_PULSE;
+			}
+
+			const PULSE_TYPE typeA = dataPulseType(protocol.data0pulsePair.durationA,
+					protocol.data1pulsePair.durationA, durationA);
+			const PULSE_TYPE typeB = dataPulseType(protocol.data0pulsePair.durationB,
+					protocol.data1pulsePair.durationB, durationB);
+			if(typeA == typeB && typeB != PULSE_TYPE::UNKNOWN) {
+				if(result == PULSE_TYPE::UNKNOWN) { /* keep the first match */
+					result = typeB;
+				}
+			} else {
+				candidates &= ~bit;
+			}
+		}
+		mCandidates[c] = candidates;
+		return result;
+	}
+
+	TEXT_ISR_ATTR_2_INLINE void pushDataBit(const size_t c, const bool bit) {
+		const uint32_t bitsCount = mBitsCount[c];
+		if(bitsCount < MAX_MSG_PACKET_BITS) {
+			receivedValue_t& word = mBits[bitsCount / VALUE_BITS][c];
+			word = (word << 1) | (bit ? 1 : 0);
+		}
+		mBitsCount[c] = bitsCount + 1;
+	}
+
+	TEXT_ISR_ATTR_2_INLINE size_t packetBitsCount(const size_t c) const {
+		return mBitsCount[c] < MAX_MSG_PACKET_BITS ? mBitsCount[c] : MAX_MSG_PACKET_BITS;
+	}
+
+	/** Refer to Receiver::retry(). */
+	TEXT_ISR_ATTR_2_INLINE void retry(const size_t c) {
+		mBitsCount[c] = 0;
+		for(size_t w = 0; w < RCSWITCH_UINT32_ARRAY_SIZE; w++) {
+			mBits[w][c] = 0;
+		}
+		mPulseCount[c] = 0;
+	}
+
+	/** Refer to Receiver::reset(). */
+	TEXT_ISR_ATTR_2_INLINE void reset(const size_t c) {
+		mCandidates[c] = 0;
+		mDataPulseCount[c] = 0;
+		retry(c);
+	}
+
+	/** Refer to Receiver::validatePacket(). */
+	TEXT_ISR_ATTR_2_INLINE bool validatePacket(const size_t c) {
+		const RxTimingSpecTable& table = mRxTimingSpecTables[mProtocolGroup[c]];
+		candidateMask_t candidates = mCandidates[c];
+		/* Like the Receiver, validating protocols reject overflown packets. */
+		const bool bOverflow = mBitsCount[c] > MAX_MSG_PACKET_BITS;
+		MessagePacket packet;
+		bool bUnpacked = false;
+		for(size_t i = 0; i < table.size; i++) {
+			const candidateMask_t bit = static_cast<candidateMask_t>(1) << i;
+			const packet_validator_t packetValidator = table.start[i].packetValidator;
+			if((candidates & bit) && packetValidator) {
+				if(bOverflow) {
+					candidates &= ~bit;
+					continue;
+				}
+				if(not bUnpacked) {
+					/* The validation policies work on the unpacked data bits. */
+					const size_t bitsCount = packetBitsCount(c);
+					const size_t lastWordBitsCount = bitsCount % VALUE_BITS;
+					for(size_t bitPos = 0; bitPos < bitsCount; bitPos++) {
+						const size_t w = bitPos / VALUE_BITS;
+						const size_t wordBitsCount = (lastWordBitsCount && w == bitsCount / VALUE_BITS) ?
+								lastWordBitsCount : VALUE_BITS;
+						const size_t shift = wordBitsCount - 1 - bitPos % VALUE_BITS;
+						packet.push((mBits[w][c] >> shift) & 1 ? DATA_BIT::LOGICAL_1 : DATA_BIT::LOGICAL_0);
+					}
+					bUnpacked = true;
+				}
+				if(not packetValidator(packet)) {
+					candidates &= ~bit;
+				}
+			}
+		}
+		mCandidates[c] = candidates;
+		return candidates != 0;
+	}
+
+	TEXT_ISR_ATTR_2_INLINE void publishPacket(const size_t c) {
+		MultiChannelPacket packet;
+		const size_t bitsCount = packetBitsCount(c);
+		packet.mBitsCount = mBitsCount[c];
+		packet.mValuesCount = (bitsCount + VALUE_BITS - 1) / VALUE_BITS;
+		for(size_t w = 0; w < RCSWITCH_UINT32_ARRAY_SIZE; w++) {
+			packet.mValues[w] = w < packet.mValuesCount ? mBits[w][c] : 0;
+		}
+		const RxTimingSpecTable& table = mRxTimingSpecTables[mProtocolGroup[c]];
+		packet.mProtocolCount = 0;
+		const candidateMask_t candidates = mCandidates[c];
+		for(size_t i = 0; i < table.size; i++) {
+			if(candidates & (static_cast<candidateMask_t>(1) << i)) {
+				packet.mProtocolNumbers[packet.mProtocolCount++] = table.start[i].protocolNumber;
+			}
+		}
+		reset(c);
+		if(mPacketSink) {
+			mPacketSink->onPacket(c, packet);
+		}
+	}
+
+	/** Refer to Receiver::handleInterrupt(). */
+	TEXT_ISR_ATTR_1_INLINE void analyzePulses(const size_t c) {
+		if(mCandidates[c] == 0) {
+			collectProtocolCandidates(c);
+			return;
+		}
+		mDataPulseCount[c] = 0;
+		const PULSE_TYPE pulseType = analyzePulsePair(c);
+		if(pulseType == PULSE_TYPE::SYCH_PULSE && packetBitsCount(c) >= MIN_MSG_PACKET_BITS && validatePacket(c)) {
+			publishPacket(c);
+		} else if(pulseType == PULSE_TYPE::SYCH_PULSE || pulseType == PULSE_TYPE::UNKNOWN) {
+			/* Start from scratch. Current pulses might be the synch start,
+			 * but for a different protocol. */
+			mCandidates[c] = 0;
+			collectProtocolCandidates(c);
+			retry(c);
+		} else {
+			pushDataBit(c, pulseType == PULSE_TYPE::DATA_LOGICAL_01);
+		}
+	}
+
+public:
+	MultiChannelReceiver() : mRxTimingSpecTables{{nullptr, 0}, {nullptr, 0}}, mPacketSink(nullptr) {
+		for(size_t c = 0; c < CHANNELS_COUNT; c++) {
+			mUsecLastEdge[c] = 0;
+			mPulseDurationA[c] = 0;
+			mPulseDurationB[c] = 0;
+			mPulseLevels[c] = 0;
+			mProtocolGroup[c] = NORMAL_LEVEL_PROTOCOLS;
+			reset(c);
+		}
+	}
+
+	static constexpr size_t channelsCount() {return CHANNELS_COUNT;}
+
+	/**
+	 * Set the protocol table for receiving data. The table is used for
+	 * all channels. Refer to Receiver::setRxTimingSpecTable().
+	 */
+	void setRxTimingSpecTable(const RxTimingSpecTable& rxTimingSpecTable) {
+		size_t i = 0;
+		/* Inverse level protocols reside at the end of the table. */
+		for (; i < rxTimingSpecTable.size; i++) {
+			if (rxTimingSpecTable.start[i].bInverseLevel) {
+				break;
+			}
+		}
+		mRxTimingSpecTables[NORMAL_LEVEL_PROTOCOLS] = RxTimingSpecTable{&rxTimingSpecTable.start[0], i};
+		mRxTimingSpecTables[INVERSE_LEVEL_PROTOCOLS] = RxTimingSpecTable{&rxTimingSpecTable.start[i], rxTimingSpecTable.size - i};
+		RCSWITCH_ASSERT(mRxTimingSpecTables[NORMAL_LEVEL_PROTOCOLS].size <= MAX_PROTOCOLS_PER_GROUP);
+		RCSWITCH_ASSERT(mRxTimingSpecTables[INVERSE_LEVEL_PROTOCOLS].size <= MAX_PROTOCOLS_PER_GROUP);
+	}
+
+	void setPacketSink(MultiChannelPacketSink* packetSink) {mPacketSink = packetSink;}
+
+	/**
+	 * Advance the channels firstChannel .. firstChannel + count - 1 by one
+	 * edge each. usecEdges and pinLevels hold the time and the pin level
+	 * after the edge for each of these channels.
+	 */
+	TEXT_ISR_ATTR_0_INLINE void handleEdges(const size_t firstChannel, const size_t count,
+			const uint32_t* const usecEdges, const uint8_t* const pinLevels) {
+		RCSWITCH_ASSERT(firstChannel + count <= CHANNELS_COUNT);
+		uint32_t* const usecLastEdge = &mUsecLastEdge[firstChannel];
+		duration_t* const pulseDurationA = &mPulseDurationA[firstChannel];
+		duration_t* const pulseDurationB = &mPulseDurationB[firstChannel];
+		uint8_t* const pulseLevels = &mPulseLevels[firstChannel];
+		uint8_t* const pulseCount = &mPulseCount[firstChannel];
+		uint8_t* const dataPulseCount = &mDataPulseCount[firstChannel];
+		const candidateMask_t* const candidates = &mCandidates[firstChannel];
+
+		/* Lockstep update of the pulse windows. Branch free, so that it can
+		 * be vectorized. */
+		for(size_t i = 0; i < count; i++) {
+			const uint32_t usecDuration = usecEdges[i] - usecLastEdge[i];
+			usecLastEdge[i] = usecEdges[i];
+			pulseDurationA[i] = pulseDurationB[i];
+			/* Limit duration to the maximum value of duration_t. Refer to Pulse. */
+			pulseDurationB[i] = usecDuration > INT_TRAITS<duration_t>::MAX ?
+					INT_TRAITS<duration_t>::MAX : usecDuration;
+			pulseLevels[i] = static_cast<uint8_t>(((pulseLevels[i] << 1) & PULSE_A_HI) | (pinLevels[i] ? 0 : PULSE_B_HI));
+			pulseCount[i] = pulseCount[i] + (pulseCount[i] < DATA_PULSES_PER_BIT);
+			dataPulseCount[i] = dataPulseCount[i] + (candidates[i] != 0);
+		}
+
+		/* Analyze the channels, that have a complete pulse window. */
+		for(size_t i = 0; i < count; i++) {
+			const bool isDataState = candidates[i] != 0;
+			if(isDataState ? dataPulseCount[i] == DATA_PULSES_PER_BIT : pulseCount[i] == DATA_PULSES_PER_BIT) {
+				analyzePulses(firstChannel + i);
+			}
+		}
+	}
+
+	/** Advance a single channel by one edge. */
+	TEXT_ISR_ATTR_0_INLINE void handleEdge(const size_t channel, const int pinLevel, const uint32_t usecEdge) {
+		const uint8_t level = pinLevel ? 1 : 0;
+		handleEdges(channel, 1, &usecEdge, &level);
+	}
+};
+
+} // namespace RcSwitch
+
+#endif /* RCSWITCH_RECEIVER_INTERNAL_MULTICHANNELRECEIVER_HPP_ */
@@ -0,0 +1,164 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_INTERNAL_PACKETQUALITY_HPP_
+#define RCSWITCH_RECEIVER_INTERNAL_PACKETQUALITY_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ISR_ATTR.hpp"
+#include "RxPulseDurationType.hpp"
+
+namespace RcSwitch {
+
+/**
+ * Signal quality metrics of a received message packet. The metrics are
+ * accumulated from the data pulses during the data phase. The nominal
+ * duration of a data pulse is the center of the time range that the
+ * pulse has been matched against.
+ *
+ * Divisions are avoided within the interrupt handler. Ratios are stored
+ * as numerator and denominator and compared by cross multiplication.
+ */
+class PacketQuality {
+	/** Sum of all measured respectively nominal data pulse durations. */
+	uint32_t mUsecMeasuredSum;
+	uint32_t mUsecNominalSum;
+
+	/** The clock of the protocol that the data pulses matched. */
+	duration_t mUsecNominalClock;
+
+	/** Worst ratio of pulse deviation to nominal pulse duration. */
+	duration_t mUsecWorstDeviation;
+	duration_t mUsecWorstDeviationNominal;
+
+	/** Worst ratio of distance to the closer range bound to half the range width. */
+	duration_t mUsecTightestMargin;
+	duration_t mUsecTightestMarginHalfWidth;
+
+	/** Number of synch pulse pairs seen after the data pulses. */
+	volatile uint8_t mRepeats;
+
+public:
+	PacketQuality() {
+		reset();
+	}
+
+	TEXT_ISR_ATTR_1_INLINE void reset() {
+		mUsecMeasuredSum = 0;
+		mUsecNominalSum = 0;
+		mUsecNominalClock = 0;
+		mUsecWorstDeviation = 0;
+		mUsecWorstDeviationNominal = 1;
+		mUsecTightestMargin = 1;
+		mUsecTightestMarginHalfWidth = 1;
+		mRepeats = 0;
+	}
+
+	/**
+	 * Account a data pulse that has been matched against the time range
+	 * [lowerBound .. upperBound[ of a protocol with the given clock.
+	 */
+	TEXT_ISR_ATTR_1_INLINE void addPulse(const duration_t usecDuration,
+			const duration_t lowerBound, const duration_t upperBound, const duration_t usecClock) {
+		const duration_t usecNominal = lowerBound + (upperBound - lowerBound) / 2;
+		const duration_t usecHalfWidth = usecNominal - lowerBound;
+
+		mUsecMeasuredSum += usecDuration;
+		mUsecNominalSum += usecNominal;
+		mUsecNominalClock = usecClock;
+
+		const duration_t usecDeviation = usecDuration > usecNominal ?
+				usecDuration - usecNominal : usecNominal - usecDuration;
+		if(static_cast<uint32_t>(usecDeviation) * mUsecWorstDeviationNominal >
+				static_cast<uint32_t>(mUsecWorstDeviation) * usecNominal) {
+			mUsecWorstDeviation = usecDeviation;
+			mUsecWorstDeviationNominal = usecNominal;
+		}
+
+		const duration_t usecMargin = usecDuration > usecNominal ?
+				upperBound - usecDuration : usecDuration - lowerBound;
+		if(static_cast<uint32_t>(usecMargin) * mUsecTightestMarginHalfWidth <
+				static_cast<uint32_t>(mUsecTightestMargin) * usecHalfWidth) {
+			mUsecTightestMargin = usecMargin;
+			mUsecTightestMarginHalfWidth = usecHalfWidth;
+		}
+	}
+
+	/** Account another synch pulse pair of the received protocol. */
+	TEXT_ISR_ATTR_1_INLINE void addRepeat() {
+		if(mRepeats < UINT8_MAX) {
+			mRepeats = mRepeats + 1;
+		}
+	}
+
+	/**
+	 * Return the protocol clock, as it has been measured from the data pulses.
+	 */
+	uint32_t usecMeasuredClock() const {
+		if(mUsecNominalSum) {
+			return (static_cast<uint64_t>(mUsecNominalClock) * mUsecMeasuredSum
+					+ mUsecNominalSum / 2) / mUsecNominalSum;
+		}
+		return 0;
+	}
+
+	/**
+	 * Return the maximum deviation of a data pulse from its nominal duration
+	 * in percent of the nominal duration.
+	 */
+	unsigned percentMaxDeviation() const {
+		if(mUsecWorstDeviationNominal) {
+			return (100 * static_cast<uint32_t>(mUsecWorstDeviation)) / mUsecWorstDeviationNominal;
+		}
+		return 0;
+	}
+
+	/**
+	 * Return the distance of the data pulse that came closest to a bound of its
+	 * time range. The distance is given in percent of half the time range
+	 * width. 100% means that all pulses hit their nominal duration, 0% means that
+	 * a pulse was just at a time range bound.
+	 */
+	unsigned percentMinMargin() const {
+		return (100 * static_cast<uint32_t>(mUsecTightestMargin)) / mUsecTightestMarginHalfWidth;
+	}
+
+	/**
+	 * Return the number of synch pulse pairs seen after the data of the
+	 * message packet. The synch pulse pair that completed the message packet
+	 * is included. Further synch pulse pairs are counted as long as the
+	 * received packet is available.
+	 */
+	unsigned repeats() const {
+		return mRepeats;
+	}
+};
+
+} // namespace RcSwitch
+
+#endif /* RCSWITCH_RECEIVER_INTERNAL_PACKETQUALITY_HPP_ */
@@ -0,0 +1,325 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#include "PacketStore.hpp"
+#if not defined(ARDUINO) && defined(__unix__)
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace RcSwitch {
+
+static const char SEGMENT_MAGIC[8] = {'R', 'C', 'S', 'W', 'P', 'K', 'T', 'S'};
+
+bool PacketQuery::matches(const PacketRecord& record) const {
+	if(record.mUsecTimestamp < mUsecFrom || record.mUsecTimestamp > mUsecTo) {
+		return false;
+	}
+	if(mProtocolNumber >= 0 && record.mProtocolNumber != static_cast<unsigned>(mProtocolNumber)) {
+		return false;
+	}
+	if(mbMatchValue && record.value() != mValue) {
+		return false;
+	}
+	return true;
+}
+
+PacketStore::PacketStore(const char* directory)
+	: mDirectory(strdup(directory)), mSegments(nullptr), mSegmentsCount(0), mNextSegmentIndex(0)
+	, mScannedPagesCount(0) {
+}
+
+PacketStore::~PacketStore() {
+	close();
+	free(mDirectory);
+}
+
+uint32_t PacketStore::hashOf(const unsigned int protocolNumber, const uint32_t value) {
+	/* murmur3 finalizer */
+	uint32_t h = value ^ (protocolNumber * 0x9E3779B1u);
+	h ^= h >> 16;
+	h *= 0x85EBCA6Bu;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35u;
+	h ^= h >> 16;
+	return h;
+}
+
+/** Each 10 bits of the hash select one of the 1024 bits of the bloom filter. */
+void PacketStore::addToBloomFilter(PageIndex& pageIndex, const uint32_t hash) {
+	for(size_t i = 0; i < 3; i++) {
+		const uint16_t bit = (hash >> (10 * i)) & 0x3FF;
+		pageIndex.mBloomFilter[bit / 8] |= 1 << (bit % 8);
+	}
+}
+
+bool PacketStore::mayContain(const PageIndex& pageIndex, const uint32_t hash) {
+	for(size_t i = 0; i < 3; i++) {
+		const uint16_t bit = (hash >> (10 * i)) & 0x3FF;
+		if(not (pageIndex.mBloomFilter[bit / 8] & (1 << (bit % 8)))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool PacketStore::mapSegment(const size_t segmentIndex, const bool bCreate) {
+	char path[PATH_MAX];
+	snprintf(path, sizeof(path), "%s/segment-%06u.rcs", mDirectory, static_cast<unsigned>(segmentIndex));
+
+	const int fd = ::open(path, bCreate ? O_RDWR | O_CREAT | O_EXCL : O_RDWR, 0644);
+	if(fd < 0) {
+		return false;
+	}
+	/* Only a new file gets its size. An existing file of a different size
+	 * isn't a segment file of this format and stays untouched. */
+	struct stat st;
+	if(fstat(fd, &st) != 0 || (bCreate ? ftruncate(fd, SEGMENT_FILE_SIZE) != 0
+			: st.st_size != static_cast<off_t>(SEGMENT_FILE_SIZE))) {
+		::close(fd);
+		return false;
+	}
+	void* const address = mmap(nullptr, SEGMENT_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	/* The mapping persists after the file has been closed. */
+	::close(fd);
+	if(address == MAP_FAILED) {
+		return false;
+	}
+
+	SegmentHeader* const header = static_cast<SegmentHeader*>(address);
+	if(bCreate) {
+		/* A new file is zero filled. */
+		memcpy(header->mMagic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+		header->mVersion = FORMAT_VERSION;
+	} else if(memcmp(header->mMagic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0
+			|| header->mVersion != FORMAT_VERSION) {
+		munmap(address, SEGMENT_FILE_SIZE);
+		return false;
+	}
+
+	Segment* const segments = static_cast<Segment*>(realloc(mSegments, (mSegmentsCount + 1) * sizeof(Segment)));
+	if(not segments) {
+		munmap(address, SEGMENT_FILE_SIZE);
+		return false;
+	}
+	mSegments = segments;
+	mSegments[mSegmentsCount].mHeader = header;
+	mSegments[mSegmentsCount].mRecords = reinterpret_cast<PacketRecord*>(static_cast<uint8_t*>(address) + RECORDS_OFFSET);
+	++mSegmentsCount;
+	return true;
+}
+
+bool PacketStore::addSegment() {
+	/* Skip file indices, that have been taken meanwhile. */
+	while(not mapSegment(mNextSegmentIndex++, true)) {
+		if(errno != EEXIST) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool PacketStore::open() {
+	close();
+	if(mkdir(mDirectory, 0755) != 0 && errno != EEXIST) {
+		return false;
+	}
+	DIR* const dir = opendir(mDirectory);
+	if(not dir) {
+		return false;
+	}
+	mNextSegmentIndex = 0;
+	for(const struct dirent* entry = readdir(dir); entry; entry = readdir(dir)) {
+		unsigned segmentIndex;
+		int length = 0;
+		if(sscanf(entry->d_name, "segment-%u.rcs%n", &segmentIndex, &length) == 1
+				&& length > 0 && entry->d_name[length] == '\0' && segmentIndex >= mNextSegmentIndex) {
+			mNextSegmentIndex = segmentIndex + 1;
+		}
+	}
+	closedir(dir);
+	/* Gaps and files, that aren't segments of this format, are skipped. */
+	for(size_t segmentIndex = 0; segmentIndex < mNextSegmentIndex; segmentIndex++) {
+		mapSegment(segmentIndex, false);
+	}
+	if(mSegmentsCount == 0) {
+		return addSegment();
+	}
+	return true;
+}
+
+void PacketStore::close() {
+	for(size_t i = 0; i < mSegmentsCount; i++) {
+		msync(mSegments[i].mHeader, SEGMENT_FILE_SIZE, MS_SYNC);
+		munmap(mSegments[i].mHeader, SEGMENT_FILE_SIZE);
+	}
+	free(mSegments);
+	mSegments = nullptr;
+	mSegmentsCount = 0;
+}
+
+bool PacketStore::append(const PacketRecord& record) {
+	if(mSegmentsCount == 0) {
+		return false;
+	}
+	if(mSegments[mSegmentsCount - 1].mHeader->mRecordsCount == SEGMENT_RECORDS) {
+		if(not addSegment()) {
+			return false;
+		}
+	}
+	Segment& segment = mSegments[mSegmentsCount - 1];
+	SegmentHeader& header = *segment.mHeader;
+	const size_t i = header.mRecordsCount;
+	segment.mRecords[i] = record;
+
+	PageIndex& pageIndex = header.mPages[i / PAGE_RECORDS];
+	if(i % PAGE_RECORDS == 0 || record.mUsecTimestamp < pageIndex.mUsecFirst) {
+		pageIndex.mUsecFirst = record.mUsecTimestamp;
+	}
+	if(i % PAGE_RECORDS == 0 || record.mUsecTimestamp > pageIndex.mUsecLast) {
+		pageIndex.mUsecLast = record.mUsecTimestamp;
+	}
+	addToBloomFilter(pageIndex, hashOf(record.mProtocolNumber, record.value()));
+	if(i == 0 || record.mUsecTimestamp < header.mUsecFirst) {
+		header.mUsecFirst = record.mUsecTimestamp;
+	}
+	if(i == 0 || record.mUsecTimestamp > header.mUsecLast) {
+		header.mUsecLast = record.mUsecTimestamp;
+	}
+
+	/* The record counts, after it and the index have been written. */
+	header.mRecordsCount = i + 1;
+	return true;
+}
+
+bool PacketStore::append(const uint64_t usecTimestamp, const size_t channel, const MultiChannelPacket& packet) {
+	PacketRecord record;
+	memset(&record, 0, sizeof(record));
+	record.mUsecTimestamp = usecTimestamp;
+	record.mValuesCount = packet.mValuesCount < PACKET_RECORD_VALUES ? packet.mValuesCount : PACKET_RECORD_VALUES;
+	for(size_t i = 0; i < record.mValuesCount; i++) {
+		record.mValues[i] = packet.mValues[i];
+	}
+	record.mProtocolNumber = packet.mProtocolCount ? packet.mProtocolNumbers[0] : 0;
+	record.mBitsCount = packet.mBitsCount;
+	record.mChannel = channel;
+	record.mPercentMaxDeviation = PACKET_RECORD_UNKNOWN_QUALITY;
+	record.mPercentMinMargin = PACKET_RECORD_UNKNOWN_QUALITY;
+	record.mRepeats = PACKET_RECORD_UNKNOWN_QUALITY;
+	return append(record);
+}
+
+bool PacketStore::append(const uint64_t usecTimestamp, const size_t channel, const Receiver& receiver) {
+	if(not receiver.available()) {
+		return false;
+	}
+	PacketRecord record;
+	memset(&record, 0, sizeof(record));
+	record.mUsecTimestamp = usecTimestamp;
+	const size_t valuesCount = receiver.receivedValuesCount();
+	record.mValuesCount = valuesCount < PACKET_RECORD_VALUES ? valuesCount : PACKET_RECORD_VALUES;
+	for(size_t i = 0; i < record.mValuesCount; i++) {
+		record.mValues[i] = receiver.receivedValueAt(i);
+	}
+	const int protocolNumber = receiver.receivedProtocol(0);
+	record.mProtocolNumber = protocolNumber >= 0 ? protocolNumber : 0;
+	record.mBitsCount = receiver.receivedBitsCount();
+	record.mChannel = channel;
+	const PacketQuality* const quality = receiver.receivedPacketQuality();
+	if(quality) {
+		record.mPercentMaxDeviation = quality->percentMaxDeviation() < UINT8_MAX ? quality->percentMaxDeviation() : UINT8_MAX - 1;
+		record.mPercentMinMargin = quality->percentMinMargin() < UINT8_MAX ? quality->percentMinMargin() : UINT8_MAX - 1;
+		record.mRepeats = quality->repeats() < UINT8_MAX ? quality->repeats() : UINT8_MAX - 1;
+	} else {
+		record.mPercentMaxDeviation = PACKET_RECORD_UNKNOWN_QUALITY;
+		record.mPercentMinMargin = PACKET_RECORD_UNKNOWN_QUALITY;
+		record.mRepeats = PACKET_RECORD_UNKNOWN_QUALITY;
+	}
+	return append(record);
+}
+
+size_t PacketStore::query(const PacketQuery& query, PacketRecordVisitor& visitor) const {
+	const uint32_t hash = query.mProtocolNumber >= 0 ? hashOf(query.mProtocolNumber, query.mValue) : 0;
+	const bool bUseBloomFilter = query.mProtocolNumber >= 0 && query.mbMatchValue;
+	size_t matchesCount = 0;
+
+	for(size_t s = 0; s < mSegmentsCount; s++) {
+		const Segment& segment = mSegments[s];
+		const SegmentHeader& header = *segment.mHeader;
+		const size_t recordsCount = header.mRecordsCount;
+		if(recordsCount == 0 || header.mUsecLast < query.mUsecFrom || header.mUsecFirst > query.mUsecTo) {
+			continue;
+		}
+		const size_t pagesCount = (recordsCount + PAGE_RECORDS - 1) / PAGE_RECORDS;
+		for(size_t p = 0; p < pagesCount; p++) {
+			const PageIndex& pageIndex = header.mPages[p];
+			if(pageIndex.mUsecLast < query.mUsecFrom || pageIndex.mUsecFirst > query.mUsecTo) {
+				continue;
+			}
+			if(bUseBloomFilter && not mayContain(pageIndex, hash)) {
+				continue;
+			}
+			++mScannedPagesCount;
+			const size_t end = (p + 1) * PAGE_RECORDS < recordsCount ? (p + 1) * PAGE_RECORDS : recordsCount;
+			for(size_t i = p * PAGE_RECORDS; i < end; i++) {
+				const PacketRecord& record = segment.mRecords[i];
+				if(query.matches(record)) {
+					++matchesCount;
+					if(not visitor.visit(record)) {
+						return matchesCount;
+					}
+				}
+			}
+		}
+	}
+	return matchesCount;
+}
+
+size_t PacketStore::recordsCount() const {
+	size_t count = 0;
+	for(size_t s = 0; s < mSegmentsCount; s++) {
+		count += mSegments[s].mHeader->mRecordsCount;
+	}
+	return count;
+}
+
+uint64_t PacketStoreSink::usecNow() {
+	struct timeval now;
+	gettimeofday(&now, nullptr);
+	return static_cast<uint64_t>(now.tv_sec) * 1000000 + now.tv_usec;
+}
+
+} // namespace RcSwitch
+
+#endif // #if not defined(ARDUINO) && defined(__unix__)
@@ -0,0 +1,251 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_INTERNAL_PACKETSTORE_HPP_
+#define RCSWITCH_RECEIVER_INTERNAL_PACKETSTORE_HPP_
+
+/**
+ * The packet store is meant for gateways, that run on a unix host. It is
+ * not available for an Arduino board.
+ */
+#if not defined(ARDUINO) && defined(__unix__)
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "RcSwitch.hpp"
+#include "MultiChannelReceiver.hpp"
+
+namespace RcSwitch {
+
+/** Number of 32 bit payload words of a packet record. */
+static constexpr size_t PACKET_RECORD_VALUES = 2;
+
+/** Marks a quality metric, that is not known. */
+static constexpr uint8_t PACKET_RECORD_UNKNOWN_QUALITY = UINT8_MAX;
+
+/**
+ * A received message packet as a fixed size binary record. The payload
+ * holds the first PACKET_RECORD_VALUES values of the packet. Further
+ * values are dropped, but mBitsCount still tells the packet length.
+ */
+struct PacketRecord {
+	/** Reception time in usec, e.g. since the unix epoch. */
+	uint64_t mUsecTimestamp;
+	uint32_t mValues[PACKET_RECORD_VALUES];
+	uint16_t mProtocolNumber;
+	uint16_t mBitsCount;
+	/** The receiver respectively the channel, that received the packet. */
+	uint16_t mChannel;
+	uint8_t mValuesCount;
+	/** Refer to class PacketQuality. */
+	uint8_t mPercentMaxDeviation;
+	uint8_t mPercentMinMargin;
+	uint8_t mRepeats;
+	uint8_t mReserved[6];
+
+	inline uint32_t value() const {return mValues[0];}
+};
+
+static_assert(sizeof(PacketRecord) == 32, "PacketRecord must have a fixed size of 32 bytes.");
+
+/**
+ * Selects packet records. A record matches, if its timestamp is within
+ * [mUsecFrom .. mUsecTo] and, if given, its protocol number and its first
+ * value are equal to the ones of the query.
+ */
+struct PacketQuery {
+	uint64_t mUsecFrom;
+	uint64_t mUsecTo;
+	/** -1 matches any protocol. */
+	int mProtocolNumber;
+	bool mbMatchValue;
+	uint32_t mValue;
+
+	static PacketQuery timeRange(const uint64_t usecFrom, const uint64_t usecTo) {
+		return PacketQuery{usecFrom, usecTo, -1, false, 0};
+	}
+
+	static PacketQuery point(const unsigned int protocolNumber, const uint32_t value,
+			const uint64_t usecFrom, const uint64_t usecTo) {
+		return PacketQuery{usecFrom, usecTo, static_cast<int>(protocolNumber), true, value};
+	}
+
+	bool matches(const PacketRecord& record) const;
+};
+
+/**
+ * Receives the records of a query.
+ */
+class PacketRecordVisitor {
+public:
+	/** Return false, to stop the query. */
+	virtual bool visit(const PacketRecord& record) = 0;
+	virtual ~PacketRecordVisitor() {}
+};
+
+/**
+ * An append only store of packet records for host gateways, that keep
+ * months of received packets.
+ *
+ * The records are appended to segment files within a directory. Segment
+ * files have a fixed size and are memory mapped. The records of a segment
+ * are grouped in pages of PAGE_RECORDS records. Each segment file starts
+ * with a sparse index, that holds per page
+ * - the time range of its records,
+ * - a bloom filter of the (protocol, value) pairs of its records.
+ *
+ * Queries read the index, and only those pages, whose time range overlaps
+ * the query, and whose bloom filter may contain the (protocol, value)
+ * pair of a point query. So the operating system only needs to load the
+ * relevant pages from disk.
+ *
+ * Usage example:
+ *
+ * RcSwitch::PacketStore packetStore("/var/lib/rcswitch");
+ * packetStore.open();
+ * RcSwitch::PacketStoreSink packetSink(packetStore);
+ * multiChannelReceiver.setPacketSink(&packetSink);
+ * ...
+ * packetStore.query(RcSwitch::PacketQuery::point(1, 0x13, usecFrom, usecTo), visitor);
+ */
+class PacketStore {
+public:
+	static constexpr uint32_t FORMAT_VERSION = 1;
+	/** Records per page. One page is 4096 bytes. */
+	static constexpr size_t PAGE_RECORDS = 128;
+	static constexpr size_t SEGMENT_PAGES = 256;
+	static constexpr size_t SEGMENT_RECORDS = PAGE_RECORDS * SEGMENT_PAGES;
+	/** 1024 bits keep false positives at about 3% for 128 distinct packets per page. */
+	static constexpr size_t BLOOM_FILTER_BYTES = 128;
+
+	struct PageIndex {
+		uint64_t mUsecFirst;
+		uint64_t mUsecLast;
+		uint8_t mBloomFilter[BLOOM_FILTER_BYTES];
+	};
+
+	struct SegmentHeader {
+		char mMagic[8];
+		uint32_t mVersion;
+		/** Number of records, that have been completely written. */
+		uint32_t mRecordsCount;
+		uint64_t mUsecFirst;
+		uint64_t mUsecLast;
+		uint8_t mReserved[32];
+		PageIndex mPages[SEGMENT_PAGES];
+	};
+
+	/** The records start at the first 4096 byte page behind the header. */
+	static constexpr size_t RECORDS_OFFSET = ((sizeof(SegmentHeader) + 4095) / 4096) * 4096;
+	static constexpr size_t SEGMENT_FILE_SIZE = RECORDS_OFFSET + SEGMENT_RECORDS * sizeof(PacketRecord);
+
+private:
+	struct Segment {
+		SegmentHeader* mHeader;
+		PacketRecord* mRecords;
+	};
+
+	char* mDirectory;
+	Segment* mSegments;
+	size_t mSegmentsCount;
+	/** The file index of the next segment to be created. */
+	size_t mNextSegmentIndex;
+
+	/** Number of record pages, that have been scanned by queries. */
+	mutable size_t mScannedPagesCount;
+
+	bool mapSegment(const size_t segmentIndex, const bool bCreate);
+	bool addSegment();
+
+	static uint32_t hashOf(const unsigned int protocolNumber, const uint32_t value);
+	static void addToBloomFilter(PageIndex& pageIndex, const uint32_t hash);
+	static bool mayContain(const PageIndex& pageIndex, const uint32_t hash);
+
+public:
+	PacketStore(const char* directory);
+	~PacketStore();
+
+	/** The store owns the directory name and the segment mappings. */
+	PacketStore(const PacketStore&) = delete;
+	PacketStore& operator=(const PacketStore&) = delete;
+
+	/**
+	 * Open the store. The directory and the first segment file are created,
+	 * if they don't exist. Segment files, that can't be mapped, e.g. those
+	 * of a different size, are skipped. New segment files are numbered
+	 * behind the highest existing one. Returns false on failure.
+	 */
+	bool open();
+	void close();
+
+	bool append(const PacketRecord& record);
+
+	/** Append a packet, that has been received by a multi channel receiver. */
+	bool append(const uint64_t usecTimestamp, const size_t channel, const MultiChannelPacket& packet);
+
+	/**
+	 * Append the packet, that is available from a receiver. The quality
+	 * metrics are unknown, if no packet quality is set at the receiver.
+	 */
+	bool append(const uint64_t usecTimestamp, const size_t channel, const Receiver& receiver);
+
+	/**
+	 * Pass all matching records in the order of appending to the visitor.
+	 * Returns the number of matching records.
+	 */
+	size_t query(const PacketQuery& query, PacketRecordVisitor& visitor) const;
+
+	size_t recordsCount() const;
+	inline size_t segmentsCount() const {return mSegmentsCount;}
+
+	/** For statistics: Number of record pages, that queries have scanned so far. */
+	inline size_t scannedPagesCount() const {return mScannedPagesCount;}
+};
+
+/**
+ * A packet sink for a multi channel receiver, that appends all received
+ * packets with the current host time to a packet store.
+ */
+class PacketStoreSink : public MultiChannelPacketSink {
+	PacketStore& mPacketStore;
+public:
+	PacketStoreSink(PacketStore& packetStore) : mPacketStore(packetStore) {}
+
+	/** The current host time in usec since the unix epoch. */
+	static uint64_t usecNow();
+
+	void onPacket(const size_t channel, const MultiChannelPacket& packet) override {
+		mPacketStore.append(usecNow(), channel, packet);
+	}
+};
+
+} // namespace RcSwitch
+
+#endif // #if not defined(ARDUINO) && defined(__unix__)
+
+#endif /* RCSWITCH_RECEIVER_INTERNAL_PACKETSTORE_HPP_ */
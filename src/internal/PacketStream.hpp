@@ -0,0 +1,269 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_INTERNAL_PACKETSTREAM_HPP_
+#define RCSWITCH_RECEIVER_INTERNAL_PACKETSTREAM_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ISR_ATTR.hpp"
+
+namespace RcSwitch {
+
+/**
+ * Minimum number of data bits for accepting a message packet
+ * to be valid.
+ */
+constexpr size_t MIN_MSG_PACKET_BITS = 6;
+
+enum class STREAM_ITEM_TYPE : uint8_t {
+	/**
+	 * A new message packet begins. It is queued as soon as the packet has
+	 * MIN_MSG_PACKET_BITS data bits. Hence noise, that is decoded into a
+	 * few data bits, doesn't produce any item. mValue is 0.
+	 */
+	PACKET_START = 0,
+	/**
+	 * 32 data bits of the current message packet. The first received bit
+	 * is the highest significant bit. The last data word of a packet can
+	 * hold less than 32 bits. They are right aligned then.
+	 */
+	DATA_WORD,
+	/**
+	 * The current message packet has been completed. mValue is the total
+	 * number of data bits of the packet. mProtocolNumber is the number of
+	 * the first protocol that matched the packet.
+	 */
+	PACKET_END,
+	/**
+	 * The current message packet has been dropped, either because of
+	 * unexpected pulses or because the stream could not keep up with
+	 * the data words. All data words since PACKET_START must be discarded.
+	 */
+	PACKET_ABORT,
+};
+
+struct PacketStreamItem {
+	STREAM_ITEM_TYPE mType;
+	unsigned int mProtocolNumber;
+	uint32_t mValue;
+};
+
+/**
+ * A single producer / single consumer queue, that delivers the data bits of
+ * message packets as 32 bit data words while the packet is still being
+ * received. The producer is the receiver's interrupt handler, the consumer
+ * is the application loop.
+ * Message packets of any length can be received, independent of
+ * MAX_MSG_PACKET_BITS.
+ */
+class PacketStreamBase {
+	static_assert(MIN_MSG_PACKET_BITS < 32,
+			"Error: PACKET_START must be queued before the first DATA_WORD.");
+
+	PacketStreamItem * const mItems;
+	const uint8_t mCapacity;
+
+	/** Written by the producer only. */
+	volatile uint8_t mWriteIndex;
+	/** Written by the consumer only. */
+	volatile uint8_t mReadIndex;
+
+	/** Producer side state of the current message packet. */
+	uint32_t mDataWord;
+	uint32_t mBitCount;
+	/** Set, if the PACKET_START item of the current message packet has been queued. */
+	bool mStartQueued;
+	bool mPacketBroken;
+
+	/** Number of packets that were aborted because the queue was full. */
+	volatile uint32_t mOverflow;
+
+	TEXT_ISR_ATTR_2_INLINE uint8_t nextIndex(const uint8_t index) const {
+		return (index + 1) == mCapacity ? 0 : index + 1;
+	}
+
+	TEXT_ISR_ATTR_2_INLINE bool put(const STREAM_ITEM_TYPE type, const uint32_t value,
+			const unsigned int protocolNumber = 0) {
+		const uint8_t writeIndex = mWriteIndex;
+		const uint8_t next = nextIndex(writeIndex);
+		if(next == mReadIndex) {
+			return false; // queue is full
+		}
+		PacketStreamItem& item = mItems[writeIndex];
+		item.mType = type;
+		item.mProtocolNumber = protocolNumber;
+		item.mValue = value;
+		/* Publish the item to the consumer as the last action. */
+		mWriteIndex = next;
+		return true;
+	}
+
+	TEXT_ISR_ATTR_2_INLINE void putWord(const uint32_t word) {
+		if(not mPacketBroken) {
+			if(not put(STREAM_ITEM_TYPE::DATA_WORD, word)) {
+				mPacketBroken = true;
+			}
+		}
+	}
+
+protected:
+	PacketStreamBase(PacketStreamItem* items, const uint8_t capacity)
+		: mItems(items), mCapacity(capacity), mWriteIndex(0), mReadIndex(0)
+		, mDataWord(0), mBitCount(0), mStartQueued(false), mPacketBroken(false)
+		, mOverflow(0) {
+	}
+
+public:
+	/** ========================================================================== */
+	/** ========= Producer side, called from within interrupt context ============ */
+
+	/**
+	 * Append a data bit to the current message packet. A PACKET_START item
+	 * is emitted when the packet reaches MIN_MSG_PACKET_BITS data bits. A
+	 * DATA_WORD item is emitted as soon as 32 data bits have been collected.
+	 */
+	TEXT_ISR_ATTR_1_INLINE void pushBit(const bool bit) {
+		mDataWord = (mDataWord << 1) | (bit ? 1 : 0);
+		if(++mBitCount == MIN_MSG_PACKET_BITS) {
+			mStartQueued = put(STREAM_ITEM_TYPE::PACKET_START, 0);
+			mPacketBroken = not mStartQueued;
+		}
+		if((mBitCount % 32) == 0) {
+			putWord(mDataWord);
+			mDataWord = 0;
+		}
+	}
+
+	/**
+	 * Complete the current message packet. Remaining data bits are emitted as
+	 * a right aligned DATA_WORD item, followed by a PACKET_END item. If the
+	 * packet could not be queued completely, a PACKET_ABORT item is emitted
+	 * instead, provided that its PACKET_START item has been queued. A packet
+	 * with less than MIN_MSG_PACKET_BITS data bits is dropped silently.
+	 */
+	TEXT_ISR_ATTR_1_INLINE void endPacket(const unsigned int protocolNumber) {
+		if(mBitCount >= MIN_MSG_PACKET_BITS) {
+			if(mBitCount % 32) {
+				putWord(mDataWord);
+			}
+			if(mPacketBroken || not put(STREAM_ITEM_TYPE::PACKET_END, mBitCount, protocolNumber)) {
+				++mOverflow;
+				if(mStartQueued) {
+					put(STREAM_ITEM_TYPE::PACKET_ABORT, mBitCount);
+				}
+			}
+		}
+		restart();
+	}
+
+	/**
+	 * Drop the current message packet. A PACKET_ABORT item is emitted, if
+	 * a PACKET_START item has been emitted before.
+	 */
+	TEXT_ISR_ATTR_1_INLINE void abortPacket() {
+		if(mStartQueued) {
+			put(STREAM_ITEM_TYPE::PACKET_ABORT, mBitCount);
+		}
+		restart();
+	}
+
+	/**
+	 * Forget about the current message packet without emitting an item.
+	 * A consumer that sees a PACKET_START while a packet is still open
+	 * must treat the open packet as aborted.
+	 */
+	TEXT_ISR_ATTR_1_INLINE void restart() {
+		mDataWord = 0;
+		mBitCount = 0;
+		mStartQueued = false;
+		mPacketBroken = false;
+	}
+
+	/** Return the number of data bits of the current message packet. */
+	TEXT_ISR_ATTR_1_INLINE uint32_t bitCount() const {return mBitCount;}
+
+	/** ========================================================================== */
+	/** ========= Consumer side, called from the application loop ================ */
+
+	/**
+	 * Return true, if there is an item that can be read.
+	 */
+	inline bool available() const {return mReadIndex != mWriteIndex;}
+
+	/**
+	 * Read the oldest item from the queue.
+	 * Returns false, if the queue is empty.
+	 */
+	bool read(PacketStreamItem& item) {
+		const uint8_t readIndex = mReadIndex;
+		if(readIndex == mWriteIndex) {
+			return false;
+		}
+		item = mItems[readIndex];
+		/* Hand the slot back to the producer as the last action. */
+		mReadIndex = nextIndex(readIndex);
+		return true;
+	}
+
+	/**
+	 * Return the number of message packets that have been aborted,
+	 * because the consumer did not read the items fast enough.
+	 */
+	inline uint32_t overflowCount() const {return mOverflow;}
+};
+
+/**
+ * A packet stream with storage for ITEMS_COUNT items. One slot is kept
+ * free to distinguish a full from an empty queue.
+ *
+ * Usage example:
+ *
+ * static RcSwitch::PacketStream<16> packetStream;
+ * ...
+ * rcSwitchReceiver.setPacketStream(packetStream);
+ * rcSwitchReceiver.begin(rxProtocolTable.toTimingSpecTable());
+ * ...
+ * RcSwitch::PacketStreamItem item;
+ * while(packetStream.read(item)) {
+ *   ...
+ * }
+ */
+template<size_t ITEMS_COUNT>
+class PacketStream : public PacketStreamBase {
+	static_assert(ITEMS_COUNT > 2 && ITEMS_COUNT <= 255,
+			"Error: ITEMS_COUNT of PacketStream must be within range 3 .. 255.");
+
+	PacketStreamItem mItemStorage[ITEMS_COUNT];
+public:
+	PacketStream() : PacketStreamBase(mItemStorage, ITEMS_COUNT) {
+	}
+};
+
+} // namespace RcSwitch
+
+#endif /* RCSWITCH_RECEIVER_INTERNAL_PACKETSTREAM_HPP_ */
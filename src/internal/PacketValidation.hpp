@@ -0,0 +1,219 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_INTERNAL_PACKET_VALIDATION_HPP_
+#define RCSWITCH_RECEIVER_INTERNAL_PACKET_VALIDATION_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ISR_ATTR.hpp"
+#include "RcSwitch.hpp"
+
+/**
+ * Packet validation policies. A policy can be passed as last, optional
+ * parameter to makeTimingSpec. It is evaluated once, when a message packet
+ * of that protocol has been completed. Protocol candidates whose policy
+ * rejects the packet are removed. If no protocol candidate remains, the
+ * packet is dropped and never becomes available to the application.
+ *
+ * Bit positions count from the first received data bit, which is the most
+ * significant bit of receivedValueAt(0).
+ *
+ * Usage example:
+ *
+ * static const RxProtocolTable <
+ *   makeTimingSpec<  1, 350, 20,   1,   31,    1,  3,    3,  1, false, RcSwitch::TriState>,
+ *   makeTimingSpec< 12, 500, 20,   1,   18,    1,  2,    2,  1, false,
+ *     RcSwitch::AllOf<RcSwitch::FixedBits<0xF0000000, 0x50000000>, RcSwitch::Crc8<0x31, 0x00, 4>>>
+ * > rxProtocolTable;
+ *
+ * Validation requires the data bits to be stored in the receiver. Hence the
+ * policies are not evaluated, if the data bits are delivered through a packet
+ * stream. A packet with more than MAX_MSG_PACKET_BITS data bits lacks the
+ * overflown bits. Protocol candidates with a policy reject it without
+ * evaluating the policy.
+ */
+
+namespace RcSwitch {
+
+/**
+ * Access to the data bits of a received message packet.
+ */
+struct PacketBits {
+	/**
+	 * Return bitsCount bits starting at bit position first. The
+	 * first bit becomes the most significant one of the result.
+	 */
+	static TEXT_ISR_ATTR_2_INLINE uint32_t field(const MessagePacket& packet, const size_t first, const size_t bitsCount) {
+		uint32_t result = 0;
+		for(size_t i = first; i < first + bitsCount; i++) {
+			result = (result << 1) | (packet.at(i) == DATA_BIT::LOGICAL_1 ? 1 : 0);
+		}
+		return result;
+	}
+
+	/** Return the number of logical 1 bits within the given range. */
+	static TEXT_ISR_ATTR_2_INLINE size_t ones(const MessagePacket& packet, const size_t first, const size_t bitsCount) {
+		size_t result = 0;
+		for(size_t i = first; i < first + bitsCount; i++) {
+			if(packet.at(i) == DATA_BIT::LOGICAL_1) {
+				result++;
+			}
+		}
+		return result;
+	}
+};
+
+/**
+ * The bits selected by MASK must match PATTERN. MASK and PATTERN refer to
+ * the value returned by receivedValueAt(0), i.e. the first 32 data bits.
+ * A BITS_COUNT other than 0 additionally requires the packet to consist of
+ * exactly that number of data bits.
+ */
+template<uint32_t MASK, uint32_t PATTERN, size_t BITS_COUNT = 0>
+struct FixedBits {
+	static_assert((PATTERN & ~MASK) == 0, "Error: PATTERN has bits outside of MASK.");
+
+	static TEXT_ISR_ATTR_1_INLINE bool validate(const MessagePacket& packet) {
+		if(BITS_COUNT && packet.size() != BITS_COUNT) {
+			return false;
+		}
+		const size_t bitsCount = packet.size() < 32 ? packet.size() : 32;
+		return (PacketBits::field(packet, 0, bitsCount) & MASK) == PATTERN;
+	}
+};
+
+/**
+ * The number of logical 1 bits within BITS_COUNT bits starting at bit
+ * position FIRST_BIT must be even, respectively odd. The range includes
+ * the parity bit. A BITS_COUNT of 0 extends the range to the last bit.
+ */
+template<size_t FIRST_BIT = 0, size_t BITS_COUNT = 0, bool ODD = false>
+struct Parity {
+	static TEXT_ISR_ATTR_1_INLINE bool validate(const MessagePacket& packet) {
+		const size_t bitsCount = BITS_COUNT ? BITS_COUNT :
+				(packet.size() > FIRST_BIT ? packet.size() - FIRST_BIT : 0);
+		if(bitsCount == 0 || FIRST_BIT + bitsCount > packet.size()) {
+			return false;
+		}
+		return (PacketBits::ones(packet, FIRST_BIT, bitsCount) & 1) == (ODD ? 1 : 0);
+	}
+};
+
+/**
+ * The sum of WORDS_COUNT words of WORD_BITS bits each, starting at bit
+ * position FIRST_BIT, must match the word that follows them. The sum is
+ * taken modulo 2^WORD_BITS, e.g. WORD_BITS = 4 for a nibble sum or
+ * WORD_BITS = 8 for a byte sum.
+ */
+template<size_t FIRST_BIT, size_t WORD_BITS, size_t WORDS_COUNT>
+struct Checksum {
+	static_assert(WORD_BITS > 0 && WORD_BITS <= 16, "Error: WORD_BITS must be within range 1 .. 16.");
+	static_assert(WORDS_COUNT > 0, "Error: WORDS_COUNT must not be 0.");
+
+	static TEXT_ISR_ATTR_1_INLINE bool validate(const MessagePacket& packet) {
+		if(FIRST_BIT + (WORDS_COUNT + 1) * WORD_BITS > packet.size()) {
+			return false;
+		}
+		uint32_t sum = 0;
+		for(size_t i = 0; i < WORDS_COUNT; i++) {
+			sum += PacketBits::field(packet, FIRST_BIT + i * WORD_BITS, WORD_BITS);
+		}
+		const uint32_t mask = (static_cast<uint32_t>(1) << WORD_BITS) - 1;
+		return (sum & mask) == PacketBits::field(packet, FIRST_BIT + WORDS_COUNT * WORD_BITS, WORD_BITS);
+	}
+};
+
+/**
+ * The last 8 data bits must match the CRC-8 over the data bits from bit
+ * position FIRST_BIT up to them. The CRC is calculated most significant
+ * bit first with generator polynomial POLY and initial value INIT. The
+ * bit count need not be a multiple of 8.
+ */
+template<uint8_t POLY, uint8_t INIT = 0, size_t FIRST_BIT = 0>
+struct Crc8 {
+	static TEXT_ISR_ATTR_1_INLINE bool validate(const MessagePacket& packet) {
+		constexpr size_t CRC_BITS = 8;
+		if(FIRST_BIT + CRC_BITS >= packet.size()) {
+			return false;
+		}
+		const size_t end = packet.size() - CRC_BITS;
+		uint8_t crc = INIT;
+		for(size_t i = FIRST_BIT; i < end; i++) {
+			const bool bit = packet.at(i) == DATA_BIT::LOGICAL_1;
+			const bool msb = crc & 0x80;
+			crc = static_cast<uint8_t>(crc << 1);
+			if(msb != bit) {
+				crc ^= POLY;
+			}
+		}
+		return crc == PacketBits::field(packet, end, CRC_BITS);
+	}
+};
+
+/**
+ * PT2262 style tri-state encoding. Each code symbol consists of 2 data
+ * bits: 00 is a '0', 11 is a '1' and 01 is a floating input. The pair 10
+ * does not exist, nor does an odd number of data bits.
+ */
+struct TriState {
+	static TEXT_ISR_ATTR_1_INLINE bool validate(const MessagePacket& packet) {
+		if(packet.size() & 1) {
+			return false;
+		}
+		for(size_t i = 0; i < packet.size(); i += 2) {
+			if(packet.at(i) == DATA_BIT::LOGICAL_1 && packet.at(i+1) == DATA_BIT::LOGICAL_0) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+/**
+ * All of the given policies must accept the packet. They are evaluated
+ * in the given order.
+ */
+template<typename ...POLICIES> struct AllOf;
+
+template<typename POLICY, typename ...POLICIES>
+struct AllOf<POLICY, POLICIES...> {
+	static TEXT_ISR_ATTR_1_INLINE bool validate(const MessagePacket& packet) {
+		return POLICY::validate(packet) && AllOf<POLICIES...>::validate(packet);
+	}
+};
+
+template<>
+struct AllOf<> {
+	static TEXT_ISR_ATTR_1_INLINE bool validate(const MessagePacket&) {
+		return true;
+	}
+};
+
+} // namespace RcSwitch
+
+#endif /* RCSWITCH_RECEIVER_INTERNAL_PACKET_VALIDATION_HPP_ */
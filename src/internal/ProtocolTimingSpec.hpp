@@ -58,6 +58,24 @@ inline TimeRange::COMPARE_RESULT TimeRange::compare(uint32_t value) const {
 	return IS_WITHIN;
 }
 
+/** Forward declaration */
+class MessagePacket;
+
+/**
+ * Returns true, if the completed message packet is valid for the protocol.
+ * Refer to PacketValidation.hpp.
+ */
+typedef bool (*packet_validator_t)(const MessagePacket& packet);
+
+/** Provide the validator of a packet validation policy. void means no validation. */
+template<typename VALIDATION> constexpr packet_validator_t packetValidatorOf() {
+	return &VALIDATION::validate;
+}
+
+template<> constexpr packet_validator_t packetValidatorOf<void>() {
+	return nullptr;
+}
+
 struct RxPulsePairTimeRanges {
 	TimeRange durationA;
 	TimeRange durationB;
@@ -69,6 +87,8 @@ struct RxTimingSpec {
 	RxPulsePairTimeRanges  synchronizationPulsePair;
 	RxPulsePairTimeRanges  data0pulsePair;
 	RxPulsePairTimeRanges  data1pulsePair;
+	duration_t usecClock;
+	packet_validator_t packetValidator;
 };
 
 struct TxPulsePairTiming {
@@ -98,7 +118,19 @@ template<
 	unsigned int synchA,  unsigned int synchB,
 	unsigned int data0_A, unsigned int data0_B,
 	unsigned int data1_A, unsigned int data1_B,
-	bool inverseLevel>
+	bool inverseLevel,
+	typename packetValidation = void>
+struct makeTimingSpec;
+
+template<
+	unsigned int protocolNumber,
+	uint32_t usecClock,
+	unsigned percentTolerance,
+	unsigned int synchA,  unsigned int synchB,
+	unsigned int data0_A, unsigned int data0_B,
+	unsigned int data1_A, unsigned int data1_B,
+	bool inverseLevel,
+	typename packetValidation>
 
 struct makeTimingSpec { // Calculate the timing specification from the protocol definition.
 	static constexpr unsigned int PROTOCOL_NUMBER = protocolNumber;
@@ -137,6 +169,8 @@ struct makeTimingSpec { // Calculate the timing specification from the protocol
 			/* LOGICAL_1 data bit pulses */
 			{uSecData1_A_lowerBound, uSecData1_A_upperBound}, {uSecData1_B_lowerBound, uSecData1_B_upperBound}
 		},
+		usecClock,
+		RcSwitch::packetValidatorOf<packetValidation>(),
 	};
 
 	template<typename T> struct IS_RX_LOWER {
@@ -37,7 +37,7 @@
 
 namespace RcSwitch {
 
-enum class PULSE_LEVEL {
+enum class PULSE_LEVEL : uint8_t {
 	UNKNOWN = 0,
 	LO,
 	HI,
@@ -159,6 +159,16 @@ public:
 		return mPulse.getDuration();
 	}
 
+	/**
+	 * Get the shortest respectively the longest duration of all pulses.
+	 */
+	inline duration_t getMinDuration() const {
+		return usecMinDuration;
+	}
+	inline duration_t getMaxDuration() const {
+		return usecMaxDuration;
+	}
+
 	/**
 	 * Get the average of the minimum and maximum duration.
 	 */
@@ -70,6 +70,33 @@ template<> void PulseAnalyzer::dumpProposedTimings(typeof(Serial)& stream, uint1
 	}
 }
 
+template<> void PulseAnalyzer::dumpProposedTimings(typeof(Serial)& stream, const TimingSpecProposal& proposal) {
+	stream.println();
+	stream.print("makeTimingSpec< #,");
+	printNumWithSeparator(stream, proposal.usecClock, 3, ",");
+	printNumWithSeparator(stream, proposal.percentTolerance, 3, ",");
+	printNumWithSeparator(stream, proposal.multiples[SYNCH_A_WINDOW], 3, ",");
+	printNumWithSeparator(stream, proposal.multiples[SYNCH_B_WINDOW], 4, ",");
+	printNumWithSeparator(stream, proposal.multiples[DATA0_A_WINDOW], 4, ",");
+	printNumWithSeparator(stream, proposal.multiples[DATA0_B_WINDOW], 4, ",");
+	printNumWithSeparator(stream, proposal.multiples[DATA1_A_WINDOW], 4, ",");
+	printNumWithSeparator(stream, proposal.multiples[DATA1_B_WINDOW], 4, ",");
+	stream.print(((proposal.bInverseLevel) ? " true" : " false"));
+	stream.println(">,");
+	stream.println();
+	if(proposal.overlappingProtocolsCount) {
+		stream.print("Overlaps with ");
+		stream.print(proposal.overlappingProtocolsCount);
+		stream.print(" deployed protocol(s) by ");
+		stream.print(proposal.usecOverlap);
+		stream.println("usec.");
+	} else if(mDeployedTimingSpecTable.size) {
+		stream.println("No overlap with the deployed protocols.");
+	}
+	stream.println("-------- Replace the '#' above by a unique identifier ---------");
+	stream.println("-Example sketch PrintReceivedData.ino demonstrates application-");
+}
+
 template <> void PulseAnalyzer::dump(typeof(Serial)& stream, const char* separator) {
 #if false
 	stream.println("Identified pulse categories:");
@@ -130,7 +157,12 @@ template <> void PulseAnalyzer::dump(typeof(Serial)& stream, const char* separat
 					   "***************************************************************";
 		stream.println(frame);
 		stream.println("Protocol detection succeeded. Timing specification proposal:");
-		dumpProposedTimings(stream, 10);
+		TimingSpecProposal proposal;
+		if(proposeTimingSpec(proposal)) {
+			dumpProposedTimings(stream, proposal);
+		} else {
+			dumpProposedTimings(stream, 10);
+		}
 		stream.println(frame);
 	} else {
 		stream.println("\n"
@@ -141,12 +173,34 @@ template <> void PulseAnalyzer::dump(typeof(Serial)& stream, const char* separat
 	}
 }
 
-PulseAnalyzer::PulseAnalyzer(const RingBufferReadAccess<TraceRecord>& input, unsigned percentTolerance)
+PulseAnalyzer::PulseAnalyzer(const TraceRecordReadAccess& input, unsigned percentTolerance)
 	:mInput(input)
 	,mPercentTolerance(percentTolerance)
+	,mDeployedTimingSpecTable{nullptr, 0}
 {
 }
 
+bool PulseAnalyzer::proposeTimingSpec(TimingSpecProposal& proposal) {
+	if(not mSynchPulseCategories.isValidSynchPulsePair() || not mDataPulses.isValid()) {
+		return false;
+	}
+
+	const PulseCategory* const categories[TIMING_WINDOWS_COUNT] = {
+		&mSynchPulseCategories.at(0), &mSynchPulseCategories.at(1),
+		mDataPulses.d0A, mDataPulses.d0B, mDataPulses.d1A, mDataPulses.d1B,
+	};
+	ObservedTiming observed;
+	observed.clear();
+	for(size_t w = 0; w < TIMING_WINDOWS_COUNT; w++) {
+		observed.mRanges[w].add(categories[w]->getMinDuration());
+		observed.mRanges[w].add(categories[w]->getMaxDuration());
+	}
+
+	TimingSpecOptimizer optimizer(mDeployedTimingSpecTable);
+	optimizer.configure(OPTIMIZER_DEFAULT_PERCENT_GUARD, mPercentTolerance, OPTIMIZER_DEFAULT_USEC_MIN_CLOCK);
+	return optimizer.optimize(observed, mDataPulses.bIsInverseLevel, proposal);
+}
+
 void PulseAnalyzer::buildAllCategories() {
 	mAllPulseCategories.reset();
 	mAllPulseCategories.build(mInput, mPercentTolerance);
@@ -35,6 +35,7 @@
 #include "Pulse.hpp"
 #include "PulseTracer.hpp"
 #include "RxPulseDurationType.hpp"
+#include "TimingSpecOptimizer.hpp"
 
 namespace RcSwitch {
 
@@ -198,7 +199,7 @@ public:
 		}
 	}
 
-	void build(const RingBufferReadAccess<TraceRecord>& input, unsigned percentTolerance) {
+	void build(const TraceRecordReadAccess& input, unsigned percentTolerance) {
 		size_t i = 0;
 		for(; i < input.size(); i++) {
 			const Pulse &pulse = input.at(i).getPulse();
@@ -208,7 +209,7 @@ public:
 		sortByDuration();
 	}
 
-	void build(DataPulses& dataPulses, const RingBufferReadAccess<TraceRecord>& input, unsigned percentTolerance
+	void build(DataPulses& dataPulses, const TraceRecordReadAccess& input, unsigned percentTolerance
 			,synchPulseCategories_t& synchPulseCategories, duration_t usecSynchB) {
 
 		assert(capacity == DATA_PULSE_CATEGORIY_COUNT); // // This must be the data pulse category collection
@@ -314,8 +315,9 @@ public:
 };
 
 class PulseAnalyzer {
-	const RingBufferReadAccess<TraceRecord> mInput;
+	const TraceRecordReadAccess mInput;
 	const unsigned mPercentTolerance;
+	RxTimingSpecTable mDeployedTimingSpecTable;
 
 	PulseCategoryCollection<ALL_PULSE_CATEGORY_COUNT> mAllPulseCategories;
 	PulseCategoryCollection<SYNCH_PULSE_CATEGORIY_COUNT> mSynchPulseCategories;
@@ -327,7 +329,7 @@ class PulseAnalyzer {
 	void buildAllCategories();
 
 public:
-	PulseAnalyzer(const RingBufferReadAccess<TraceRecord>& input, unsigned percentTolerance = 20);
+	PulseAnalyzer(const TraceRecordReadAccess& input, unsigned percentTolerance = 20);
 
 	void dedcuceProtocol() {
 		buildAllCategories();
@@ -338,7 +340,23 @@ public:
 		}
 	}
 
+	/**
+	 * Set the protocol table, that the proposed timing spec shall fit into.
+	 */
+	void setDeployedTimingSpecTable(const RxTimingSpecTable& deployedTimingSpecTable) {
+		mDeployedTimingSpecTable = deployedTimingSpecTable;
+	}
+
+	/**
+	 * Propose the clock, the multiples and the tolerance for the deduced
+	 * protocol, that overlap least with the deployed protocol table.
+	 * Returns false, if the protocol could not be deduced or there is
+	 * no feasible proposal.
+	 */
+	bool proposeTimingSpec(TimingSpecProposal& proposal);
+
 	template <typename T> void dumpProposedTimings(T& stream, uint16_t clock);
+	template <typename T> void dumpProposedTimings(T& stream, const TimingSpecProposal& proposal);
 	template <typename T> void dump(T& stream, const char* separator);
 };
 
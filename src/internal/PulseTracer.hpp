@@ -33,6 +33,18 @@
 
 namespace RcSwitch {
 
+/**
+ * Number of bits used to tag a trace record with the receiver that
+ * recorded it. The tags are stored apart from the trace records, packed
+ * into bytes. Refer to SharedPulseTracer.
+ */
+constexpr size_t TRACE_SOURCE_ID_WIDTH = 2;
+constexpr uint8_t MAX_TRACE_SOURCE_ID = (1 << TRACE_SOURCE_ID_WIDTH) - 1;
+constexpr size_t TRACE_SOURCE_IDS_PER_BYTE = 8 / TRACE_SOURCE_ID_WIDTH;
+
+/** Source id filter value that selects the trace records of all sources. */
+constexpr int ANY_TRACE_SOURCE = -1;
+
 class TraceRecord {
 
 	/**
@@ -69,21 +81,111 @@ public:
 };
 
 /**
- * This container stores received pulses for debugging and pulse analysis purpose.
+ * This class allows indexed read access to the packed source ids of the
+ * trace records within a shared pulse tracer. The indices correspond to
+ * the ones of the trace records.
  */
-template<size_t PULSE_TRACES_COUNT>
-class PulseTracer : public RingBuffer<TraceRecord, PULSE_TRACES_COUNT> {
-	using baseClass = RingBuffer<TraceRecord, PULSE_TRACES_COUNT>;
+class TraceSourceIdReadAccess {
+	const uint8_t* mSourceIds;
+	size_t mCapacity;
+	size_t mBegin;
+
 public:
-	template<typename T> void dump(T& serial, const char* separator) const {
+	/** Access the source ids of a ring buffer, that is managed by the caller. */
+	TraceSourceIdReadAccess(const uint8_t* sourceIds, const size_t capacity, const size_t begin)
+		: mSourceIds(sourceIds), mCapacity(capacity), mBegin(begin) {
+	}
+
+	inline uint8_t at(const size_t index) const {
+		const size_t i = (mBegin + index) % mCapacity;
+		return (mSourceIds[i / TRACE_SOURCE_IDS_PER_BYTE] >>
+				((i % TRACE_SOURCE_IDS_PER_BYTE) * TRACE_SOURCE_ID_WIDTH)) & MAX_TRACE_SOURCE_ID;
+	}
+};
+
+/**
+ * This class allows indexed read access to the trace records of a
+ * particular source within a pulse tracer. With source id ANY_TRACE_SOURCE
+ * all trace records are accessed.
+ * Filtered access is optimized for ascending indices, which is the way
+ * the trace records are evaluated.
+ */
+class TraceRecordReadAccess {
+	const RingBufferReadAccess<TraceRecord> mInput;
+	const TraceSourceIdReadAccess mSourceIds;
+	const int mSourceId;
+	size_t mSize;
+
+	/** The last filtered index and the corresponding input index. */
+	mutable size_t mCachedIndex;
+	mutable size_t mCachedInputIndex;
+
+	inline bool isSelected(const size_t inputIndex) const {
+		return mSourceIds.at(inputIndex) == mSourceId;
+	}
+
+public:
+	/** Access all trace records of a pulse tracer, that isn't shared. */
+	TraceRecordReadAccess(const RingBufferReadAccess<TraceRecord>& input)
+		: mInput(input), mSourceIds(nullptr, 1, 0), mSourceId(ANY_TRACE_SOURCE), mSize(input.size())
+		, mCachedIndex(0), mCachedInputIndex(0) {
+	}
 
-		const size_t n = baseClass::size();
+	/** Access the trace records of a shared pulse tracer, that are tagged with the given source id. */
+	TraceRecordReadAccess(const RingBufferReadAccess<TraceRecord>& input,
+			const TraceSourceIdReadAccess& sourceIds, const int sourceId)
+		: mInput(input), mSourceIds(sourceIds), mSourceId(sourceId), mSize(0), mCachedIndex(0), mCachedInputIndex(0) {
+		if(mSourceId == ANY_TRACE_SOURCE) {
+			mSize = mInput.size();
+		} else {
+			bool first = true;
+			for(size_t i = 0; i < mInput.size(); i++) {
+				if(isSelected(i)) {
+					if(first) {
+						first = false;
+						mCachedInputIndex = i;
+					}
+					++mSize;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Return a const reference to the element at the specified index.
+	 * The index is validated by the assert() system function.
+	 */
+	const TraceRecord& at(const size_t index) const {
+		RCSWITCH_CONTAINER_ASSERT(index < mSize);
+		if(mSourceId == ANY_TRACE_SOURCE) {
+			return mInput.at(index);
+		}
+		if(index < mCachedIndex) {
+			/* Restart from the first selected record. */
+			mCachedIndex = 0;
+			mCachedInputIndex = 0;
+			while(not isSelected(mCachedInputIndex)) {
+				++mCachedInputIndex;
+			}
+		}
+		while(mCachedIndex < index) {
+			++mCachedInputIndex;
+			if(isSelected(mCachedInputIndex)) {
+				++mCachedIndex;
+			}
+		}
+		return mInput.at(mCachedInputIndex);
+	}
+
+	size_t size() const {return mSize;}
+
+	template<typename T> void dump(T& serial, const char* separator, const size_t indexWidth) const {
+		const size_t n = size();
 		if(n > 0) {
 			uint32_t interruptLoadSum = 0;
 			uint32_t pulseDurationSum = 0;
 
 			size_t i = 0;
-			const size_t indexWidth = decimalDigits(PULSE_TRACES_COUNT);
 			while(i < n) {
 				const TraceRecord& traceRecord = at(i);
 				traceRecord.dump(serial, separator, i, indexWidth);
@@ -99,6 +201,19 @@ public:
 		}
 		serial.println();
 	}
+};
+
+/**
+ * This container stores received pulses for debugging and pulse analysis purpose.
+ */
+template<size_t PULSE_TRACES_COUNT>
+class PulseTracer : public RingBuffer<TraceRecord, PULSE_TRACES_COUNT> {
+	using baseClass = RingBuffer<TraceRecord, PULSE_TRACES_COUNT>;
+public:
+	template<typename T> void dump(T& serial, const char* separator) const {
+		const RingBufferReadAccess<TraceRecord> readAccess(*this);
+		TraceRecordReadAccess(readAccess).dump(serial, separator, decimalDigits(PULSE_TRACES_COUNT));
+	}
 
 	PulseTracer() {
 	}
@@ -118,6 +233,105 @@ public:
 	 */
 	using baseClass::at;
 };
+
+/**
+ * Passing this value as PULSE_TRACES_COUNT to the RcSwitchReceiver API class
+ * makes the receiver trace its pulses into a SharedPulseTracer instead of
+ * a pulse tracer of its own.
+ */
+constexpr size_t SHARED_PULSE_TRACER = static_cast<size_t>(-1);
+
+/**
+ * The size independent part of a pulse tracer that is shared among
+ * multiple receivers. It's a ring buffer of trace records and their
+ * source ids within the storage of the derived class. Refer to
+ * SharedPulseTracer.
+ */
+class SharedPulseTracerBase {
+	TraceRecord * const mRecords;
+	uint8_t * const mSourceIds;
+	const size_t mCapacity;
+
+	/** The index of the oldest trace record and the number of trace records. */
+	size_t mBegin;
+	size_t mSize;
+
+protected:
+	SharedPulseTracerBase(TraceRecord* const records, uint8_t* const sourceIds, const size_t capacity)
+		: mRecords(records), mSourceIds(sourceIds), mCapacity(capacity), mBegin(0), mSize(0) {
+	}
+
+public:
+	/**
+	 * Tracing is locked while the trace records are evaluated. This
+	 * affects all receivers that share this pulse tracer.
+	 */
+	volatile mutable bool mPulseTracingLocked = false;
+
+	/**
+	 * Store a new pulse that has been received from the given source. If
+	 * the capacity has been reached, the oldest trace record is dropped.
+	 */
+	TEXT_ISR_ATTR_1_INLINE void tracePulse(const duration_t usecPulseDuration, const PULSE_LEVEL pulseLevel,
+			const duration_t usecInterruptDuration, const uint8_t sourceId) {
+		size_t index = mBegin + mSize;
+		if(index >= mCapacity) {
+			index -= mCapacity;
+		}
+		mRecords[index].set(usecPulseDuration, pulseLevel, usecInterruptDuration);
+		uint8_t& sourceIds = mSourceIds[index / TRACE_SOURCE_IDS_PER_BYTE];
+		const uint8_t shift = (index % TRACE_SOURCE_IDS_PER_BYTE) * TRACE_SOURCE_ID_WIDTH;
+		sourceIds = (sourceIds & ~(MAX_TRACE_SOURCE_ID << shift)) | (sourceId << shift);
+		if(mSize < mCapacity) {
+			++mSize;
+		} else if(++mBegin == mCapacity) {
+			mBegin = 0;
+		}
+	}
+
+	/**
+	 * Return read access to the trace records of the given source. With
+	 * source id ANY_TRACE_SOURCE all trace records are accessed.
+	 */
+	TraceRecordReadAccess readAccess(const int sourceId = ANY_TRACE_SOURCE) const {
+		const RingBufferReadAccess<TraceRecord> records(mRecords, mCapacity, mSize, mBegin);
+		if(sourceId == ANY_TRACE_SOURCE) {
+			return TraceRecordReadAccess(records);
+		}
+		return TraceRecordReadAccess(records, TraceSourceIdReadAccess(mSourceIds, mCapacity, mBegin), sourceId);
+	}
+
+	size_t capacity() const {
+		return mCapacity;
+	}
+};
+
+/**
+ * A pulse tracer that serves multiple receivers. Each receiver tags its
+ * trace records with a source id within range 0 .. MAX_TRACE_SOURCE_ID.
+ * So a single RAM budget serves all IO pins. The tags take 1 byte per
+ * TRACE_SOURCE_IDS_PER_BYTE trace records. The interrupt handlers of
+ * the receivers must not preempt each other.
+ *
+ * Usage example:
+ *
+ * static RcSwitch::SharedPulseTracer<140> pulseTracer;
+ * static RcSwitchReceiver<2, RcSwitch::SHARED_PULSE_TRACER> rcSwitchReceiver433;
+ * static RcSwitchReceiver<3, RcSwitch::SHARED_PULSE_TRACER> rcSwitchReceiver315;
+ * ...
+ * rcSwitchReceiver433.attachPulseTracer(pulseTracer, 0);
+ * rcSwitchReceiver315.attachPulseTracer(pulseTracer, 1);
+ */
+template<size_t PULSE_TRACES_COUNT>
+class SharedPulseTracer : public SharedPulseTracerBase {
+	static_assert(PULSE_TRACES_COUNT > 0, "Error: A shared pulse tracer needs at least one trace record.");
+	TraceRecord mStorage[PULSE_TRACES_COUNT];
+	uint8_t mSourceIdStorage[(PULSE_TRACES_COUNT + TRACE_SOURCE_IDS_PER_BYTE - 1) / TRACE_SOURCE_IDS_PER_BYTE];
+public:
+	SharedPulseTracer() : SharedPulseTracerBase(mStorage, mSourceIdStorage, PULSE_TRACES_COUNT) {
+	}
+};
+
 } // namespace RcSwitch
 
 #if not defined(ESP32) && not defined(ESP8266)
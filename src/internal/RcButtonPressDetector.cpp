@@ -90,7 +90,7 @@ void RcButtonPressDetector::scanRcButtons() {
 				// Stay in ON state.
 			} else {
 				// Button released. Record release time and move to off delay state.
-				mOffDelayStartTime = millis();
+				mOffDelayStartTime = RcSwitch::millis_();
 				mRcButtonState = STATE::OFF_DELAY;
 			}
 			break;
@@ -103,7 +103,7 @@ void RcButtonPressDetector::scanRcButtons() {
 					onButtonPressed(button);
 					mLastPressedButton = button;
 				} else {
-					const uint32_t time = millis();
+					const uint32_t time = RcSwitch::millis_();
 					if ((time - mOffDelayStartTime) > mDebounceDelayTime) {
 						// The same button was pressed again after off
 						// delay has expired, signal it.
@@ -115,7 +115,7 @@ void RcButtonPressDetector::scanRcButtons() {
 				mRcButtonState = STATE::ON;
 			} else {
 				// All buttons still released in OFF delay state.
-				const uint32_t time = millis();
+				const uint32_t time = RcSwitch::millis_();
 				if ((time - mOffDelayStartTime) > mDebounceDelayTime) {
 					// Off delay time expired, move to OFF state.
 					mRcButtonState = STATE::OFF;
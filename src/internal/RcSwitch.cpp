@@ -25,6 +25,7 @@
 
 #include "ProtocolTimingSpec.hpp"
 #include "RcSwitch.hpp"
+#include "PacketValidation.hpp"
 
 #if defined(ESP32) || defined(ESP8266)
 #include "RcSwitch.inc"
@@ -35,10 +36,28 @@
 
 namespace RcSwitch {
 
+#ifdef ENABLE_RCSWITCH_TEST
+uint64_t (*usecTimeHook)() = nullptr;
+#endif
+
 uint32_t micros_() {
+#ifdef ENABLE_RCSWITCH_TEST
+	if(usecTimeHook) {
+		return static_cast<uint32_t>(usecTimeHook());
+	}
+#endif
 	return micros();
 }
 
+uint32_t millis_() {
+#ifdef ENABLE_RCSWITCH_TEST
+	if(usecTimeHook) {
+		return static_cast<uint32_t>(usecTimeHook() / 1000);
+	}
+#endif
+	return millis();
+}
+
 
 static TEXT_ISR_ATTR_2 PulseTypes pulseAtoPulseTypes(const RxTimingSpec& protocol, const Pulse &pulse) {
 	PulseTypes result = { PULSE_TYPE::UNKNOWN, PULSE_TYPE::UNKNOWN };
@@ -180,15 +199,41 @@ PULSE_TYPE Receiver::analyzePulsePair(const Pulse& pulseA, const Pulse& pulseB)
 			}
 		} else {
 			// The pulses do not match the protocol
+			logEvent(DECODER_EVENT::CANDIDATE_PRUNED, mProtocolCandidates[protocolCandidatesIndex] |
+				(mProtocolCandidates.getProtocolGroup() == INVERSE_LEVEL_PROTOCOLS ? DECODER_EVENT_INVERSE_LEVEL_FLAG : 0));
 			mProtocolCandidates.remove(protocolCandidatesIndex);
 		}
 	}
 	return result;
 }
 
+bool Receiver::isReceptionWindowOpen(const uint32_t usecInterruptEntry) {
+	if(not mReceptionScheduler || mReceptionScheduler->isWindowOpen(usecInterruptEntry)) {
+		return true;
+	}
+	/* Between the reception windows. Drop a partially received packet and
+	 * any pending synch pulse, so that decoding starts from scratch, when
+	 * the next window opens. */
+	if(state() == DATA_STATE) {
+		abandonPacket();
+	} else if(state() == SYNC_STATE && size() > 0) {
+		baseClass::reset();
+	}
+	return false;
+}
+
+void Receiver::abandonPacket() {
+	mProtocolCandidates.reset();
+	mDataModePulseCount = 0;
+	retry();
+}
+
 void Receiver::handleInterrupt(const int pinLevel, const uint32_t usecInterruptEntry) {
-	if(!mSuspended) {
-		const uint32_t usecDuration = usecInterruptEntry - mUsecLastInterrupt;
+	const uint32_t usecDuration = usecInterruptEntry - mUsecLastInterrupt;
+	if(mBandMonitor) {
+		mBandMonitor->addPulse(usecDuration, pinLevel);
+	}
+	if(!mSuspended && isReceptionWindowOpen(usecInterruptEntry)) {
 		push(usecDuration, pinLevel);
 
 		switch(state()) {
@@ -198,6 +243,8 @@ void Receiver::handleInterrupt(const int pinLevel, const uint32_t usecInterruptE
 					const Pulse& pulseB = at(size()-1);
 
 					collectProtocolCandidates(pulseA, pulseB);
+					logProtocolCandidates();
+					observeSynchPulses(pulseA, pulseB);
 					/* If the above call has identified any valid protocol
 					 * candidate, the state has implicitly become DATA_STATE.
 					 * Refer to function state(). */
@@ -210,26 +257,32 @@ void Receiver::handleInterrupt(const int pinLevel, const uint32_t usecInterruptE
 					const Pulse& pulseB = at(size()-1);
 					const PULSE_TYPE pulseType = analyzePulsePair(pulseA, pulseB);
 					if(pulseType == PULSE_TYPE::UNKNOWN) {
+						logPacketEvent(DECODER_EVENT::ABORTED_UNKNOWN_PULSES);
 						/* Unknown pulses received, hence start from scratch. Current pulses
 						 * might be the synch start, but for a different protocol. */
 						mProtocolCandidates.reset();
 						/* Check current pulses for being a synch of a different protocol. */
 						collectProtocolCandidates(pulseA, pulseB);
+						logProtocolCandidates();
 						retry();
+						observeSynchPulses(pulseA, pulseB);
 					} else {
 						if(pulseType == PULSE_TYPE::SYCH_PULSE) {
 							/* The 2 pulses are a new sync start, we are finished
 							 * with the current message package */
-							if(mReceivedMessagePacket.size() >= MIN_MSG_PACKET_BITS) {
-								mMessageAvailable = true;
+							if(acceptPacket()) {
+								observeSynchPulses(pulseA, pulseB);
+								publishPacket();
 							} else {
-								/* Insufficient number of bits received, hence start from
-								 * scratch. Current pulses might be the synch start, but
-								 * for a different protocol. */
+								/* Insufficient number of bits or an invalid packet received,
+								 * hence start from scratch. Current pulses might be the synch
+								 * start, but for a different protocol. */
 								mProtocolCandidates.reset();
 								/* Check current pulses for being a synch of a different protocol. */
 								collectProtocolCandidates(pulseA, pulseB);
+								logProtocolCandidates();
 								retry();
+								observeSynchPulses(pulseA, pulseB);
 							}
 						} else {
 							/* It is a sequence of 2 data pulses */
@@ -237,13 +290,20 @@ void Receiver::handleInterrupt(const int pinLevel, const uint32_t usecInterruptE
 									|| pulseType == PULSE_TYPE::DATA_LOGICAL_01);
 							const DATA_BIT dataBit = pulseType == PULSE_TYPE::DATA_LOGICAL_00 ?
 											DATA_BIT::LOGICAL_0 : DATA_BIT::LOGICAL_1;
-							mReceivedMessagePacket.push(dataBit);
+							if(mPacketQuality || mTimingTuner) {
+								measureDataPulses(pulseA, pulseB, dataBit);
+							}
+							pushDataBit(dataBit);
 						}
 					}
 				}
 				break;
 			case AVAILABLE_STATE:
 				/* Do nothing. */
+				logEvent(DECODER_EVENT::EDGE_DROPPED, 0);
+				if(mPacketQuality && size() > 1) {
+					countRepeat(at(size()-2), at(size()-1));
+				}
 				break;
 		}
 	}
@@ -264,13 +324,181 @@ Receiver::STATE Receiver::state() const {
 }
 
 void Receiver::retry() {
+	if(mPacketStream) {
+		mPacketStream->abortPacket();
+	}
 	mReceivedMessagePacket.reset();
+	if(mPacketQuality) {
+		mPacketQuality->reset();
+	}
+	if(mTimingTuner) {
+		mTimingTuner->restartPacket();
+	}
 	baseClass::reset();
 }
 
+void Receiver::pushDataBit(const DATA_BIT dataBit) {
+	logEvent(DECODER_EVENT::BIT_APPENDED, static_cast<uint8_t>(dataBit));
+	if(mPacketStream) {
+		mPacketStream->pushBit(dataBit == DATA_BIT::LOGICAL_1);
+	} else {
+		mReceivedMessagePacket.push(dataBit);
+	}
+}
+
+size_t Receiver::packetBitsCount() const {
+	if(mPacketStream) {
+		return mPacketStream->bitCount();
+	}
+	return mReceivedMessagePacket.size();
+}
+
+bool Receiver::acceptPacket() {
+	if(packetBitsCount() < MIN_MSG_PACKET_BITS) {
+		logPacketEvent(DECODER_EVENT::ABORTED_TOO_SHORT);
+		return false;
+	}
+	/* Streamed data bits are not stored, hence they can't be validated. */
+	if(not mPacketStream && not validatePacket()) {
+		logPacketEvent(DECODER_EVENT::ABORTED_INVALID);
+		return false;
+	}
+	return true;
+}
+
+bool Receiver::validatePacket() {
+	const RxTimingSpecTable protocols = getRxTimingTable(mProtocolCandidates.getProtocolGroup());
+	/* The message packet lacks the overflown data bits. So the validators
+	 * can't check the packet and reject it. */
+	const bool bOverflow = mReceivedMessagePacket.overflowCount() != 0;
+	size_t protocolCandidatesIndex = mProtocolCandidates.size();
+	while(protocolCandidatesIndex > 0) {
+		--protocolCandidatesIndex;
+		const packet_validator_t packetValidator =
+				protocols.start[mProtocolCandidates[protocolCandidatesIndex]].packetValidator;
+		if(packetValidator && (bOverflow || not packetValidator(mReceivedMessagePacket))) {
+			logEvent(DECODER_EVENT::CANDIDATE_PRUNED, mProtocolCandidates[protocolCandidatesIndex] |
+				(mProtocolCandidates.getProtocolGroup() == INVERSE_LEVEL_PROTOCOLS ? DECODER_EVENT_INVERSE_LEVEL_FLAG : 0));
+			mProtocolCandidates.remove(protocolCandidatesIndex);
+		}
+	}
+	return mProtocolCandidates.size() > 0;
+}
+
+void Receiver::publishPacket() {
+	logPacketEvent(DECODER_EVENT::PACKET_PUBLISHED);
+	if(mPacketQuality) {
+		mPacketQuality->addRepeat();
+	}
+	if(mTimingTuner) {
+		/* Packets that match multiple protocols are ambiguous. */
+		if(mProtocolCandidates.size() == 1) {
+			const RxTimingSpecTable protocols = getRxTimingTable(mProtocolCandidates.getProtocolGroup());
+			mTimingTuner->completePacket(&protocols.start[mProtocolCandidates[0]]);
+		} else {
+			mTimingTuner->restartPacket();
+		}
+	}
+	if(mReceptionScheduler) {
+		/* Streamed data bits are not stored, hence they can't identify the source. */
+		const size_t bitsCount = mPacketStream ? 0 : mReceivedMessagePacket.size();
+		const uint32_t id = PacketBits::field(mReceivedMessagePacket, 0,
+				bitsCount < 32 ? bitsCount : 32) & mReceptionScheduler->idMask();
+		/* The time of the previous edge is good enough for learning the interval. */
+		mReceptionScheduler->addPacket(getProtcolNumber(0), id, mUsecLastInterrupt);
+	}
+	if(mPacketStream) {
+		/* The packet has already been streamed. The synch pulses that
+		 * completed this packet start the next one, hence stay in
+		 * DATA_STATE with the current protocol candidates. */
+		mPacketStream->endPacket(getProtcolNumber(0));
+		if(mPacketQuality) {
+			mPacketQuality->reset();
+		}
+	} else {
+		mMessageAvailable = true;
+	}
+}
+
+void Receiver::measureDataPulses(const Pulse& pulseA, const Pulse& pulseB, const DATA_BIT dataBit) {
+	/* The protocol candidate with the highest index is the
+	 * one that determined the data bit. Refer to analyzePulsePair(). */
+	const RxTimingSpecTable protocols = getRxTimingTable(mProtocolCandidates.getProtocolGroup());
+	const RxTimingSpec& protocol = protocols.start[mProtocolCandidates[mProtocolCandidates.size()-1]];
+	const RxPulsePairTimeRanges& pulsePair = dataBit == DATA_BIT::LOGICAL_0 ?
+			protocol.data0pulsePair : protocol.data1pulsePair;
+	if(mPacketQuality) {
+		mPacketQuality->addPulse(pulseA.getDuration(),
+				pulsePair.durationA.lowerBound, pulsePair.durationA.upperBound, protocol.usecClock);
+		mPacketQuality->addPulse(pulseB.getDuration(),
+				pulsePair.durationB.lowerBound, pulsePair.durationB.upperBound, protocol.usecClock);
+	}
+	if(mTimingTuner) {
+		mTimingTuner->addDataPulses(dataBit == DATA_BIT::LOGICAL_1, pulseA.getDuration(), pulseB.getDuration());
+	}
+}
+
+void Receiver::observeSynchPulses(const Pulse& pulseA, const Pulse& pulseB) {
+	if(mTimingTuner && mProtocolCandidates.size()) {
+		mTimingTuner->addSynchPulses(pulseA.getDuration(), pulseB.getDuration());
+	}
+}
+
+void Receiver::countRepeat(const Pulse& pulseA, const Pulse& pulseB) {
+	const bool isInverseLevel = mProtocolCandidates.getProtocolGroup() == INVERSE_LEVEL_PROTOCOLS;
+	if(pulseA.getLevel() == (isInverseLevel ? PULSE_LEVEL::LO : PULSE_LEVEL::HI)) {
+		const RxTimingSpecTable protocols = getRxTimingTable(mProtocolCandidates.getProtocolGroup());
+		const RxPulsePairTimeRanges& synch = protocols.start[mProtocolCandidates[0]].synchronizationPulsePair;
+		/* First synch pulse is allowed to be longer */
+		if(pulseA.getDuration() >= synch.durationA.lowerBound &&
+				synch.durationB.compare(pulseB.getDuration()) == TimeRange::IS_WITHIN) {
+			mPacketQuality->addRepeat();
+		}
+	}
+}
+
+bool Receiver::tuneTimingSpec() {
+	if(mTimingTuner == nullptr || not mTimingTuner->isUpdatePending()) {
+		return false;
+	}
+	if(mSuspended) {
+		/* The interrupt handler doesn't touch the time ranges. */
+		return mTimingTuner->update();
+	}
+	/* Check and suspend atomically. Otherwise a packet that becomes
+	 * available meanwhile would be dropped below. */
+	noInterrupts();
+	if(available()) {
+		interrupts();
+		return false;
+	}
+	mSuspended = true;
+	interrupts();
+
+	const bool result = mTimingTuner->update();
+
+	/* Edges have been skipped while suspended. Hence drop the partially
+	 * received packet and the pulses, but not the queued stream items,
+	 * which reset() would do. No packet can have become available. */
+	noInterrupts();
+	abandonPacket();
+	mSuspended = false;
+	interrupts();
+	return result;
+}
+
 void Receiver::reset() {
+	if(mPacketStream) {
+		mPacketStream->restart();
+	}
 	mProtocolCandidates.reset();
 	mReceivedMessagePacket.reset();
+	if(mPacketQuality) {
+		mPacketQuality->reset();
+	}
+	if(mTimingTuner) {
+		mTimingTuner->restartPacket();
+	}
 	baseClass::reset();
 	/* Changing this flag must be the last action here,
 	 * because it will change the state. That must not
@@ -281,7 +509,7 @@ void Receiver::reset() {
 	mMessageAvailable = false;
 }
 
-unsigned int Receiver::receivedBitsCount() const {
+size_t Receiver::receivedBitsCount() const {
 	if(available()) {
 		const MessagePacket& messagePacket = mReceivedMessagePacket;
 		return messagePacket.size() + messagePacket.overflowCount();
@@ -36,6 +36,12 @@
 #include "Pulse.hpp"
 #include "PulseTracer.hpp"
 #include "PulseAnalyzer.hpp"
+#include "PacketStream.hpp"
+#include "DecoderEventLog.hpp"
+#include "PacketQuality.hpp"
+#include "TimingTuner.hpp"
+#include "BandMonitor.hpp"
+#include "ReceptionScheduler.hpp"
 
 #if not defined DEBUG_RCSWITCH
 #define DEBUG_RCSWITCH false
@@ -83,11 +89,7 @@ constexpr size_t MAX_MSG_PACKET_BITS = 8 * sizeof(receivedValue_t) * RCSWITCH_UI
  */
 constexpr size_t MAX_PROTOCOL_CANDIDATES = 7;
 
-/**
- * Minimum number of data bits for accepting a message packet
- * to be valid.
- */
-constexpr size_t MIN_MSG_PACKET_BITS = 6;
+/* MIN_MSG_PACKET_BITS is defined in PacketStream.hpp. */
 
 /**
  * A high level pulse followed by a low level pulse constitute
@@ -103,14 +105,17 @@ enum class DATA_BIT : int8_t {
 	LOGICAL_1 = 1,
 };
 
-enum PROTOCOL_GROUP_ID {
+enum PROTOCOL_GROUP_ID : int8_t {
 	UNKNOWN_PROTOCOL       = -1,
 	NORMAL_LEVEL_PROTOCOLS  = 0,
 	INVERSE_LEVEL_PROTOCOLS = 1,
 };
 
-/** A protocol candidate is identified by an index. */
-typedef size_t PROTOCOL_CANDIDATE;
+/**
+ * A protocol candidate is identified by its index within the
+ * protocol table of its group.
+ */
+typedef uint8_t PROTOCOL_CANDIDATE;
 
 /**
  * This container stores the all the protocols that match the
@@ -138,6 +143,9 @@ public:
 	TEXT_ISR_ATTR_2 PROTOCOL_GROUP_ID getProtocolGroup() const {
 		return mProtocolGroupId;
 	}
+
+	/** Return the candidate mask for the SYNCH_MATCHED decoder event. */
+	TEXT_ISR_ATTR_1_INLINE uint8_t toEventArgument() const;
 };
 
 /**
@@ -170,26 +178,65 @@ public:
  * received the state becomes AVAILABLE until the reset function
  * is called.
  */
-class Receiver : public RingBuffer<Pulse, DATA_PULSES_PER_BIT> {
+class Receiver : public RingBuffer<Pulse, DATA_PULSES_PER_BIT>
+		, private DecoderEventLog<RCSWITCH_EVENT_LOG_SIZE> {
 private:
 	/** =========================================================================== */
 	/** == Privately used types, enumerations, variables and methods ============== */
 	using baseClass = RingBuffer<Pulse, DATA_PULSES_PER_BIT>;
+	/**
+	 * Records what the decoder did with the received pulses. It is a base
+	 * class, because the disabled event log is empty and takes no space then.
+	 */
+	using eventLog_t = DecoderEventLog<RCSWITCH_EVENT_LOG_SIZE>;
 	friend class RcSwitch_test;
+	friend class ReceiverTestAccess;
 
 	/** API class becomes friend. */
 	template<int IOPIN, size_t PULSE_TRACES_COUNT> friend class ::RcSwitchReceiver;
 
+	/**
+	 * The members are ordered by access frequency. The state that is
+	 * touched on every edge follows the pulse ring buffer of the base
+	 * class as a contiguous block, ahead of the rarely touched packet
+	 * storage. The size of that block isn't checked, it grows with every
+	 * optional feature pointer. An enabled event log base class precedes
+	 * the block.
+	 */
+
+	/** ========= Hot state, touched on every edge ======================= */
+protected:
+	uint32_t mUsecLastInterrupt;
+private:
+	ProtocolCandidates mProtocolCandidates;
+	uint8_t mDataModePulseCount;
+	volatile bool mMessageAvailable;
+	volatile bool mSuspended;
+
+	/**
+	 * If set, data bits are streamed into this queue instead of being
+	 * stored in mReceivedMessagePacket.
+	 */
+	PacketStreamBase* mPacketStream;
+
+	/** If set, every edge is accounted here, regardless of the decoder state. */
+	BandMonitor* mBandMonitor;
+
+	/** If set, edges between the reception windows of periodic sources are dropped. */
+	ReceptionSchedulerBase* mReceptionScheduler;
+
+	/** ========= Warm state, read for every complete pulse pair ========= */
 	RxTimingSpecTable mRxTimingSpecTableNormal;
 	RxTimingSpecTable mRxTimingSpecTableInverse;
 
-	MessagePacket mReceivedMessagePacket;
+	/** If set, collects signal quality metrics of the received packet. */
+	PacketQuality* mPacketQuality;
 
-	volatile bool mMessageAvailable;
-	volatile bool mSuspended;
+	/** If set, learns the pulse timing from the received packets. */
+	TimingTunerBase* mTimingTuner;
 
-	ProtocolCandidates mProtocolCandidates;
-	size_t mDataModePulseCount;
+	/** ========= Cold state, the storage of the received data bits ====== */
+	MessagePacket mReceivedMessagePacket;
 
 	enum STATE {AVAILABLE_STATE, SYNC_STATE, DATA_STATE};
 	enum STATE state() const;
@@ -199,10 +246,21 @@ private:
 	TEXT_ISR_ATTR_1 void push(uint32_t usecDuration, const int pinLevel);
 	TEXT_ISR_ATTR_1 PULSE_TYPE analyzePulsePair(const Pulse& firstPulse, const Pulse& secondPulse);
 	TEXT_ISR_ATTR_1 void retry();
+	TEXT_ISR_ATTR_1 void abandonPacket();
+	TEXT_ISR_ATTR_1 void pushDataBit(const DATA_BIT dataBit);
+	TEXT_ISR_ATTR_1 size_t packetBitsCount() const;
+	TEXT_ISR_ATTR_1 bool acceptPacket();
+	TEXT_ISR_ATTR_1 bool validatePacket();
+	TEXT_ISR_ATTR_1 void publishPacket();
+	TEXT_ISR_ATTR_1_INLINE bool isReceptionWindowOpen(const uint32_t usecInterruptEntry);
+	TEXT_ISR_ATTR_1 void measureDataPulses(const Pulse& pulseA, const Pulse& pulseB, const DATA_BIT dataBit);
+	TEXT_ISR_ATTR_1 void countRepeat(const Pulse& pulseA, const Pulse& pulseB);
+	TEXT_ISR_ATTR_1 void observeSynchPulses(const Pulse& pulseA, const Pulse& pulseB);
+	TEXT_ISR_ATTR_1_INLINE void logEvent(const DECODER_EVENT event, const size_t argument);
+	TEXT_ISR_ATTR_1_INLINE void logPacketEvent(const DECODER_EVENT event);
+	TEXT_ISR_ATTR_1_INLINE void logProtocolCandidates();
 
 protected:
-	uint32_t mUsecLastInterrupt;
-
 	/** ========================================================================== */
 	/** ========= Methods used by API class RcSwitchReceiver ===================== */
 
@@ -216,9 +274,17 @@ protected:
 	 * Default constructor.
 	 */
 	Receiver()
-		    : mRxTimingSpecTableNormal{nullptr, 0}, mRxTimingSpecTableInverse{nullptr, 0}
-		    , mMessageAvailable(false), mSuspended(false)
-			, mDataModePulseCount(0), mUsecLastInterrupt(0)	{
+		    : mUsecLastInterrupt(0), mDataModePulseCount(0)
+		    , mMessageAvailable(false), mSuspended(false), mPacketStream(nullptr), mBandMonitor(nullptr)
+		    , mReceptionScheduler(nullptr)
+		    , mRxTimingSpecTableNormal{nullptr, 0}, mRxTimingSpecTableInverse{nullptr, 0}
+		    , mPacketQuality(nullptr), mTimingTuner(nullptr) {
+	}
+
+	/** The whole protocol table. The inverse level protocols follow the normal ones. */
+	RxTimingSpecTable getRxTimingTable() const {
+		return RxTimingSpecTable{mRxTimingSpecTableNormal.start,
+			mRxTimingSpecTableNormal.size + mRxTimingSpecTableInverse.size};
 	}
 
 private:
@@ -227,6 +293,45 @@ private:
 	 */
 	void setRxTimingSpecTable(const RxTimingSpecTable& rxTimingSpecTable);
 
+	/**
+	 * Deliver received data bits through the given packet stream.
+	 * Must be called before the receiver starts receiving interrupts.
+	 */
+	void setPacketStream(PacketStreamBase* packetStream) {mPacketStream = packetStream;}
+
+	/**
+	 * Learn the pulse timing from received packets with the given timing
+	 * tuner. Must be called before the receiver starts receiving interrupts.
+	 */
+	void setTimingTuner(TimingTunerBase* timingTuner) {mTimingTuner = timingTuner;}
+
+	/**
+	 * Collect signal quality metrics of the received packet in the given
+	 * object. Must be called before the receiver starts receiving interrupts.
+	 */
+	void setPacketQuality(PacketQuality* packetQuality) {mPacketQuality = packetQuality;}
+
+	/**
+	 * Account every edge in the given band monitor. Must be called before
+	 * the receiver starts receiving interrupts.
+	 */
+	void setBandMonitor(BandMonitor* bandMonitor) {mBandMonitor = bandMonitor;}
+
+	/**
+	 * Decode only within the reception windows of the given reception
+	 * scheduler. Must be called before the receiver starts receiving
+	 * interrupts.
+	 */
+	void setReceptionScheduler(ReceptionSchedulerBase* receptionScheduler) {mReceptionScheduler = receptionScheduler;}
+
+	/**
+	 * Narrow the time ranges of the timing tuner's shadow table. Does
+	 * nothing while a received packet is available. Otherwise the
+	 * receiver skips the edges meanwhile and drops a partially received
+	 * packet. Returns true, if the time ranges have been updated.
+	 */
+	bool tuneTimingSpec();
+
 	/**
 	 * Remove protocol candidates for the mProtocolCandidates buffer.
 	 * Remove the all data pulses from this container.
@@ -247,18 +352,36 @@ public:
 	size_t receivedBitsCount() const;
 	inline size_t receivedProtocolCount() const {return mProtocolCandidates.size();}
 	int receivedProtocol(const size_t index) const;
+	inline const PacketQuality* receivedPacketQuality() const {return mPacketQuality;}
 	void suspend() {mSuspended = true;}
 	void resume() {if(mSuspended) {reset(); mSuspended=false;}}
 	unsigned int getProtcolNumber(const size_t protocolCandidateIndex) const;
 	void resetAvailable() {if(available()) {reset();}}
+	template<typename T> size_t dumpDecoderEvents(T& serial, const size_t maxCount) {
+		return eventLog_t::dump(serial, maxCount);
+	}
 
 };
 
 /**
  * Just delegate to ::micros(). The reason is to avoid include of "Arduino.h" within this file.
+ * When tests are enabled, the time is taken from usecTimeHook instead, if it is set.
  */
 TEXT_ISR_ATTR_1 uint32_t micros_();
 
+/**
+ * Just delegate to ::millis(). Refer to micros_().
+ */
+uint32_t millis_();
+
+#ifdef ENABLE_RCSWITCH_TEST
+/**
+ * If set, micros_() and millis_() return the time of this function, which
+ * is given in microseconds. Refer to class VirtualClock in test/VirtualTime.hpp.
+ */
+extern uint64_t (*usecTimeHook)();
+#endif
+
 
 template<size_t PULSE_TRACES_COUNT>
 class ReceiverWithPulseTracer : public Receiver {
@@ -309,6 +432,7 @@ public:
 		if(bDeduceProtocol){
 			const RingBufferReadAccess<TraceRecord> readAccess(mPulseTracer);
 			PulseAnalyzer pulseAnalyzer(readAccess);
+			pulseAnalyzer.setDeployedTimingSpecTable(getRxTimingTable());
 			stream.println("\n==== Deducing RC protocol: ===== ");
 			pulseAnalyzer.dedcuceProtocol();
 			pulseAnalyzer.dump(stream, separator);
@@ -325,11 +449,103 @@ void ReceiverWithPulseTracer<PULSE_TRACES_COUNT>::handleInterrupt(const int pinL
 	tracePulse(usecInterruptEntry, pinLevel, usecLastInterrupt);
 }
 
+/**
+ * A receiver that stores the received pulses in a pulse tracer, which is
+ * shared with other receivers. The trace records are tagged with the
+ * source id of this receiver.
+ */
+class ReceiverWithSharedPulseTracer : public Receiver {
+	friend class RcSwitch_test;
+
+	/** API class becomes friend. */
+	template<int IOPIN, size_t PULSE_TRACES_COUNT> friend class ::RcSwitchReceiver;
+
+	SharedPulseTracerBase* mSharedPulseTracer = nullptr;
+	uint8_t mSourceId = 0;
+
+	/** Store a new pulse in the shared trace buffer. */
+	TEXT_ISR_ATTR_1 void tracePulse(const uint32_t usecInterruptEntry, const int pinLevel, const uint32_t usecLastInterrupt) {
+		SharedPulseTracerBase * const sharedPulseTracer = mSharedPulseTracer;
+		if(sharedPulseTracer && not sharedPulseTracer->mPulseTracingLocked) {
+			const uint32_t usecPulseDuration = usecInterruptEntry - usecLastInterrupt;
+			const uint32_t usecInteruptDuration = micros_() - usecInterruptEntry;
+			const PULSE_LEVEL pulseLevel = pinLevel ? PULSE_LEVEL::LO : PULSE_LEVEL::HI;
+			sharedPulseTracer->tracePulse(usecPulseDuration, pulseLevel, usecInteruptDuration, mSourceId);
+		}
+	}
+
+	/** ========================================================================== */
+	/** ========= Methods used by API class RcSwitchReceiver ===================== */
+
+	/**
+	 * Evaluate a new pulse that has been received. Will
+	 * only be called from within interrupt context.
+	 */
+	TEXT_ISR_ATTR_0_INLINE void handleInterrupt(const int pinLevel, const uint32_t usecInterruptEntry) {
+		const uint32_t usecLastInterrupt = mUsecLastInterrupt;
+		Receiver::handleInterrupt(pinLevel, usecInterruptEntry);
+		tracePulse(usecInterruptEntry, pinLevel, usecLastInterrupt);
+	}
+
+	bool attachPulseTracer(SharedPulseTracerBase* sharedPulseTracer, const uint8_t sourceId) {
+		if(sourceId > MAX_TRACE_SOURCE_ID) {
+			return false;
+		}
+		mSourceId = sourceId;
+		mSharedPulseTracer = sharedPulseTracer;
+		return true;
+	}
+
+public:
+	/**
+	 * Return the number of trace records of this receiver, that are
+	 * currently stored in the shared pulse tracer.
+	 */
+	size_t tracedPulsesCount() const {
+		if(mSharedPulseTracer) {
+			return mSharedPulseTracer->readAccess(mSourceId).size();
+		}
+		return 0;
+	}
+
+	/**
+	 * For the following methods, refer to corresponding API
+	 * class RcSwitchReceiver.
+	 */
+	template <typename T>
+	void dumpAndDedcucePulses(T& stream, const char* separator, bool bDumpPulses, bool bDeduceProtocol) const {
+		if(not mSharedPulseTracer) {
+			stream.println("No pulse tracer attached.");
+			return;
+		}
+		mSharedPulseTracer->mPulseTracingLocked = true;
+		const TraceRecordReadAccess readAccess = mSharedPulseTracer->readAccess(mSourceId);
+		if(bDumpPulses) {
+			stream.println("\n==== Dumping traced pulses: ==== ");
+			readAccess.dump(stream, separator, decimalDigits(mSharedPulseTracer->capacity()));
+			stream.println("==== done!                 ===== ");
+		}
+		if(bDeduceProtocol){
+			PulseAnalyzer pulseAnalyzer(readAccess);
+			pulseAnalyzer.setDeployedTimingSpecTable(getRxTimingTable());
+			stream.println("\n==== Deducing RC protocol: ===== ");
+			pulseAnalyzer.dedcuceProtocol();
+			pulseAnalyzer.dump(stream, separator);
+			stream.println("==== done!                 ===== ");
+		}
+		mSharedPulseTracer->mPulseTracingLocked = false;
+	}
+};
+
 static constexpr size_t MIN_PULSE_TRACES_FOR_PROTOCOL_DEDUCTION = 132;
 static const char* const toLessPulseTracesError =
 	"The PULSE_TRACES_COUNT parameter of your RcSwitchReceiver is too "
 	"low for protocol deduction. Please change to 132 or higher.";
 
+static const char* const toLessSharedPulseTracesError =
+	"The shared pulse tracer holds too less pulses of this receiver "
+	"for protocol deduction. 132 or more are required.";
+
 static const char* const noPulsesToTraceError = "The PULSE_TRACES_COUNT "
 	"parameter is 0. There are no pulses to dump.";
 
@@ -377,6 +593,30 @@ template<> struct ReceiverSelector<0> {
 	}
 };
 
+/**
+ * Specialize ReceiverSelector for PULSE_TRACES_COUNT being SHARED_PULSE_TRACER.
+ * This implementation will select class ReceiverWithSharedPulseTracer as
+ * receiver_t. The number of traced pulses is determined by the attached
+ * SharedPulseTracer and is checked at run time.
+ */
+template<> struct ReceiverSelector<SHARED_PULSE_TRACER> {
+	using receiver_t = ReceiverWithSharedPulseTracer;
+
+	template<typename T>
+	static void dumpPulseTracer(const receiver_t& receiver, T& stream, const char* separator) {
+		receiver.dumpAndDedcucePulses(stream, separator, true, false);
+	}
+
+	template<typename T>
+	static void deduceProtocolFromPulseTracer(const receiver_t& receiver, T& stream) {
+		if(receiver.tracedPulsesCount() < MIN_PULSE_TRACES_FOR_PROTOCOL_DEDUCTION) {
+			stream.println(toLessSharedPulseTracesError);
+		} else {
+			receiver.dumpAndDedcucePulses(stream, "", false, true);
+		}
+	}
+};
+
 } /* namespace RcSwitch */
 
 #if not defined(ESP32) && not defined(ESP8266)
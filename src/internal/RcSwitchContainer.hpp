@@ -296,6 +296,11 @@ public:
 		: mData(ringBuffer.mData), mCapacity(CAPACITY), mSize(ringBuffer.size()), mBegin(ringBuffer.mBegin) {
 	}
 
+	/** Access a ring buffer, that is managed by the caller. */
+	RingBufferReadAccess(const ELEMENT_TYPE* data, const size_t capacity, const size_t size, const size_t begin)
+		: mData(data), mCapacity(capacity), mSize(size), mBegin(begin) {
+	}
+
 	/**
 	 * Return a const reference to the element at the specified index.
 	 * The index is validated by the assert() system function.
@@ -0,0 +1,276 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#include "ReceptionScheduler.hpp"
+
+namespace RcSwitch {
+
+/** Default tolerance of the burst times in percent of the interval. */
+static constexpr unsigned DEFAULT_PERCENT_TOLERANCE = 1;
+
+/**
+ * Default minimum guard time around the expected bursts. The first packet of
+ * a burst is published one packet duration after the burst has started, so
+ * the guard time must exceed the duration of a packet.
+ */
+static constexpr uint32_t DEFAULT_USEC_MIN_GUARD = 100000;
+
+/** Default number of bursts, that a locked source may miss in a row. */
+static constexpr uint8_t DEFAULT_MISSES_LIMIT = 2;
+
+/**
+ * Default number of longest intervals between the discovery windows. The
+ * receiver decodes all of the time for about 6% of the time then.
+ */
+static constexpr uint8_t DEFAULT_DISCOVERY_INTERVALS = 16;
+
+ReceptionSchedulerBase::ReceptionSchedulerBase(PeriodicSource* sources, const size_t capacity, const uint32_t idMask)
+	: mSources(sources), mCapacity(capacity), mIdMask(idMask)
+	, mPercentTolerance(DEFAULT_PERCENT_TOLERANCE), mUsecMinGuard(DEFAULT_USEC_MIN_GUARD)
+	, mMissesLimit(DEFAULT_MISSES_LIMIT), mDiscoveryIntervals(DEFAULT_DISCOVERY_INTERVALS) {
+	reset();
+}
+
+void ReceptionSchedulerBase::reset() {
+	mSourcesCount = 0;
+	mOverflow = false;
+	mGating = false;
+	mUsecWindowOpen = 0;
+	mUsecWindowClose = 0;
+	mDiscovering = false;
+	mDiscoveryScheduled = false;
+	mUsecDiscovery = 0;
+	mGatedEdgesCount = 0;
+	mResetRequested = false;
+}
+
+uint32_t ReceptionSchedulerBase::usecGuard(const PeriodicSource& source) const {
+	return mUsecMinGuard + source.mUsecInterval / 100 * mPercentTolerance;
+}
+
+uint32_t ReceptionSchedulerBase::usecWindowClose(const PeriodicSource& source) const {
+	return source.mUsecNextBurst + source.mUsecBurstLength + usecGuard(source);
+}
+
+void ReceptionSchedulerBase::pendingWindow(const PeriodicSource& source, const uint32_t usecNow,
+		uint32_t& usecOpen, uint32_t& usecClose) const {
+	const uint32_t usecGuardTime = usecGuard(source);
+	usecClose = source.mUsecBurstStart + source.mUsecBurstLength + usecGuardTime;
+	if(isAfter(usecClose, usecNow)) {
+		/* The current burst is still being received. */
+		usecOpen = source.mUsecBurstStart - usecGuardTime;
+	} else {
+		usecOpen = source.mUsecNextBurst - usecGuardTime;
+		usecClose = usecWindowClose(source);
+	}
+}
+
+void ReceptionSchedulerBase::learnBurst(PeriodicSource& source, const uint32_t usecNow) {
+	const uint32_t usecDelta = usecNow - source.mUsecBurstStart;
+	bool bConfirmed = false;
+	if(source.mUsecInterval) {
+		/* Bursts may have been missed in between. */
+		const uint32_t bursts = (usecDelta + source.mUsecInterval / 2) / source.mUsecInterval;
+		const uint32_t usecExpected = bursts * source.mUsecInterval;
+		const uint32_t usecError = usecDelta > usecExpected ? usecDelta - usecExpected : usecExpected - usecDelta;
+		bConfirmed = bursts > 0 && usecError <= usecGuard(source);
+		if(bConfirmed && bursts == 1) {
+			/* Follow a slowly drifting transmitter clock. */
+			source.mUsecInterval = source.mUsecInterval - source.mUsecInterval / 4 + usecDelta / 4;
+		}
+	}
+	if(bConfirmed) {
+		if(source.mConfirmations < UINT8_MAX) {
+			++source.mConfirmations;
+		}
+	} else {
+		source.mUsecInterval = usecDelta;
+		source.mConfirmations = 0;
+	}
+	source.mMisses = 0;
+	source.mUsecBurstStart = usecNow;
+	source.mUsecNextBurst = usecNow + source.mUsecInterval;
+}
+
+void ReceptionSchedulerBase::remove(const size_t index) {
+	mSources[index] = mSources[--mSourcesCount];
+	mOverflow = false;
+}
+
+void ReceptionSchedulerBase::addPacket(const unsigned int protocolNumber, const uint32_t id, const uint32_t usecNow) {
+	if(mResetRequested) {
+		reset();
+	}
+	size_t i = 0;
+	for(; i < mSourcesCount; i++) {
+		if(mSources[i].mProtocolNumber == protocolNumber && mSources[i].mId == id) {
+			break;
+		}
+	}
+
+	if(i < mSourcesCount) {
+		PeriodicSource& source = mSources[i];
+		if(usecNow - source.mUsecLastPacket < RECEPTION_USEC_BURST_GAP) {
+			/* Another packet of the current burst. */
+			if(usecNow - source.mUsecBurstStart > source.mUsecBurstLength) {
+				source.mUsecBurstLength = usecNow - source.mUsecBurstStart;
+			}
+		} else {
+			learnBurst(source, usecNow);
+		}
+		source.mUsecLastPacket = usecNow;
+	} else if(mSourcesCount < mCapacity) {
+		PeriodicSource& source = mSources[mSourcesCount++];
+		source.mProtocolNumber = protocolNumber;
+		source.mId = id;
+		source.mUsecBurstStart = usecNow;
+		source.mUsecLastPacket = usecNow;
+		source.mUsecBurstLength = 0;
+		source.mUsecInterval = 0;
+		source.mUsecNextBurst = usecNow;
+		source.mConfirmations = 0;
+		source.mMisses = 0;
+	} else {
+		/* An unknown transmitter must not be shut out. */
+		mOverflow = true;
+	}
+	update(usecNow);
+}
+
+bool ReceptionSchedulerBase::isDiscoveryWindowOpen(const uint32_t usecNow, const uint32_t usecLongestInterval) {
+	if(mDiscovering) {
+		if(isAfter(mUsecDiscovery, usecNow)) {
+			return true;
+		}
+		mDiscovering = false;
+		mDiscoveryScheduled = false;
+	}
+	/* Keep the time differences within the range of isAfter(). */
+	const uint32_t usecPause = usecLongestInterval < RECEPTION_USEC_FORGET / mDiscoveryIntervals ?
+			mDiscoveryIntervals * usecLongestInterval : RECEPTION_USEC_FORGET;
+	if(not mDiscoveryScheduled) {
+		mUsecDiscovery = usecNow + usecPause;
+		mDiscoveryScheduled = true;
+	}
+	if(isAfter(mUsecDiscovery, usecNow)) {
+		return false;
+	}
+	/* The discovery window may have been noticed late, so it lasts one
+	 * longest interval from now on. */
+	mDiscovering = true;
+	mUsecDiscovery = usecNow + usecLongestInterval;
+	return true;
+}
+
+void ReceptionSchedulerBase::update(const uint32_t usecNow) {
+	bool bGating = mSourcesCount > 0 && not mOverflow;
+	bool bWindowFound = false;
+	uint32_t usecFirstOpen = 0;
+	uint32_t usecFirstClose = 0;
+	uint32_t usecLongestInterval = 0;
+
+	size_t i = mSourcesCount;
+	while(i > 0) {
+		--i;
+		PeriodicSource& source = mSources[i];
+		if(not source.isLocked()) {
+			if(isAfter(usecNow, source.mUsecLastPacket + RECEPTION_USEC_FORGET)) {
+				remove(i);
+			} else {
+				bGating = false;
+			}
+			continue;
+		}
+
+		if(not isAfter(source.mUsecBurstStart + source.mUsecBurstLength + usecGuard(source), usecNow)) {
+			while(isAfter(usecNow, usecWindowClose(source)) && source.isLocked()) {
+				/* The expected burst has been missed. */
+				source.mUsecNextBurst += source.mUsecInterval;
+				if(++source.mMisses > mMissesLimit) {
+					/* Fall back to decoding all of the time, until the source
+					 * has been locked again or is forgotten. */
+					source.mConfirmations = 0;
+					source.mUsecLastPacket = usecNow;
+				}
+			}
+			if(not source.isLocked()) {
+				bGating = false;
+				continue;
+			}
+		}
+		if(source.mUsecInterval > usecLongestInterval) {
+			usecLongestInterval = source.mUsecInterval;
+		}
+
+		/* The window that opens first is the current one. A wide window of
+		 * a long interval source may contain the windows of others. */
+		uint32_t usecOpen;
+		uint32_t usecClose;
+		pendingWindow(source, usecNow, usecOpen, usecClose);
+		if(not bWindowFound || isAfter(usecFirstOpen, usecOpen)
+				|| (usecFirstOpen == usecOpen && isAfter(usecClose, usecFirstClose))) {
+			usecFirstOpen = usecOpen;
+			usecFirstClose = usecClose;
+			bWindowFound = true;
+		}
+	}
+
+	/* Keep the window open until the last of the overlapping windows has closed. */
+	bool bExtended = bWindowFound;
+	while(bExtended) {
+		bExtended = false;
+		for(i = 0; i < mSourcesCount; i++) {
+			if(not mSources[i].isLocked()) {
+				continue;
+			}
+			uint32_t usecOpen;
+			uint32_t usecClose;
+			pendingWindow(mSources[i], usecNow, usecOpen, usecClose);
+			if(not isAfter(usecOpen, usecFirstClose) && isAfter(usecClose, usecFirstClose)) {
+				usecFirstClose = usecClose;
+				bExtended = true;
+			}
+		}
+	}
+
+	if(bGating && bWindowFound && mDiscoveryIntervals) {
+		if(isDiscoveryWindowOpen(usecNow, usecLongestInterval)) {
+			/* Decode from now on, until the discovery window has closed. */
+			usecFirstOpen = usecNow;
+			if(isAfter(mUsecDiscovery, usecFirstClose)) {
+				usecFirstClose = mUsecDiscovery;
+			}
+		}
+	} else {
+		mDiscovering = false;
+		mDiscoveryScheduled = false;
+	}
+
+	mUsecWindowOpen = usecFirstOpen;
+	mUsecWindowClose = usecFirstClose;
+	mGating = bGating && bWindowFound;
+}
+
+} // namespace RcSwitch
@@ -0,0 +1,253 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_INTERNAL_RECEPTIONSCHEDULER_HPP_
+#define RCSWITCH_RECEIVER_INTERNAL_RECEPTIONSCHEDULER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ISR_ATTR.hpp"
+
+namespace RcSwitch {
+
+/**
+ * Packets of the same source, that are published within this time after
+ * the previous one, belong to the same burst of repeated transmissions.
+ */
+constexpr uint32_t RECEPTION_USEC_BURST_GAP = 500000;
+
+/**
+ * A source that is not locked, is forgotten after this time. Must stay below half the micros() wrap around
+ * time of about 71 minutes. So must the intervals of the periodic sources.
+ */
+constexpr uint32_t RECEPTION_USEC_FORGET = 600000000;
+
+/** Number of confirmed intervals, before the phase of a source is trusted. */
+constexpr uint8_t RECEPTION_LOCK_CONFIRMATIONS = 2;
+
+/**
+ * A transmitter that is identified by the protocol number and the
+ * identifier bits of its packets.
+ */
+struct PeriodicSource {
+	unsigned int mProtocolNumber;
+	uint32_t mId;
+
+	/** Publish time of the first and the last packet of the latest burst. */
+	uint32_t mUsecBurstStart;
+	uint32_t mUsecLastPacket;
+
+	/** The longest burst seen so far. */
+	uint32_t mUsecBurstLength;
+
+	/** The learned interval between the bursts. 0, if unknown. */
+	uint32_t mUsecInterval;
+
+	/** The expected publish time of the first packet of the next burst. */
+	uint32_t mUsecNextBurst;
+
+	uint8_t mConfirmations;
+	uint8_t mMisses;
+
+	inline bool isLocked() const {return mConfirmations >= RECEPTION_LOCK_CONFIRMATIONS;}
+};
+
+/**
+ * Learns interval and phase of periodic transmitters, e.g. sensors, from
+ * the packets that the receiver publishes. As soon as all sources heard so
+ * far are locked, the receiver only decodes edges within the reception
+ * windows around the expected bursts. Edges between the windows are
+ * dropped at the cost of a time comparison.
+ *
+ * A locked source, that missed more than the configured number of bursts
+ * in a row, is unlocked. As long as there is any source that is not locked,
+ * the receiver decodes all of the time. A source that isn't locked again
+ * within RECEPTION_USEC_FORGET, is forgotten.
+ *
+ * Transmitters that start sending while the receiver drops edges between
+ * the windows, are heard within discovery windows: After the configured
+ * number of the longest learned interval, the receiver decodes all of the
+ * time for one longest interval. A new source heard meanwhile makes the
+ * receiver decode all of the time, until the new source is locked, too.
+ * A transmitter with a longer interval may need several discovery windows.
+ * requestReset() forgets all sources while the receiver is running.
+ */
+class ReceptionSchedulerBase {
+	PeriodicSource* const mSources;
+	const size_t mCapacity;
+	const uint32_t mIdMask;
+	size_t mSourcesCount;
+
+	/** Set, when a source has been heard, that didn't fit into mSources. */
+	bool mOverflow;
+
+	/** Set, when edges outside of the reception windows are dropped. */
+	volatile bool mGating;
+	uint32_t mUsecWindowOpen;
+	uint32_t mUsecWindowClose;
+
+	/** Set by the application. The interrupt handler acts on it. */
+	volatile bool mResetRequested;
+
+	/** Set, while the receiver decodes all of the time to discover new sources. */
+	bool mDiscovering;
+	/** Set, when mUsecDiscovery holds the start of the next discovery window. */
+	bool mDiscoveryScheduled;
+	/** The start of the next respectively the end of the current discovery window. */
+	uint32_t mUsecDiscovery;
+
+	volatile uint32_t mGatedEdgesCount;
+
+	unsigned mPercentTolerance;
+	uint32_t mUsecMinGuard;
+	uint8_t mMissesLimit;
+	uint8_t mDiscoveryIntervals;
+
+	/** Returns true, if time a is later than time b. Correct across the micros() wrap around. */
+	static TEXT_ISR_ATTR_2_INLINE bool isAfter(const uint32_t a, const uint32_t b) {
+		return static_cast<int32_t>(a - b) > 0;
+	}
+
+	TEXT_ISR_ATTR_2 uint32_t usecGuard(const PeriodicSource& source) const;
+	TEXT_ISR_ATTR_2 uint32_t usecWindowClose(const PeriodicSource& source) const;
+	/** The window of the burst being received at usecNow, else of the next expected burst. */
+	TEXT_ISR_ATTR_2 void pendingWindow(const PeriodicSource& source, const uint32_t usecNow,
+			uint32_t& usecOpen, uint32_t& usecClose) const;
+	TEXT_ISR_ATTR_2 void learnBurst(PeriodicSource& source, const uint32_t usecNow);
+	TEXT_ISR_ATTR_2 void remove(const size_t index);
+	TEXT_ISR_ATTR_2 bool isDiscoveryWindowOpen(const uint32_t usecNow, const uint32_t usecLongestInterval);
+	TEXT_ISR_ATTR_1 void update(const uint32_t usecNow);
+
+protected:
+	ReceptionSchedulerBase(PeriodicSource* sources, const size_t capacity, const uint32_t idMask);
+
+public:
+	/** ========================================================================== */
+	/** ========= Called from within interrupt context =========================== */
+
+	/**
+	 * Returns true, if the edge at usecEdge is to be decoded. Called for
+	 * every edge.
+	 */
+	TEXT_ISR_ATTR_1_INLINE bool isWindowOpen(const uint32_t usecEdge) {
+		if(not mGating) {
+			return true;
+		}
+		if(isAfter(usecEdge, mUsecWindowClose)) {
+			update(usecEdge);
+			if(not mGating) {
+				return true;
+			}
+		}
+		if(isAfter(mUsecWindowOpen, usecEdge)) {
+			mGatedEdgesCount = mGatedEdgesCount + 1;
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Account a packet, that has been published at usecNow. id holds the
+	 * bits of the first received value, that are set in idMask().
+	 */
+	TEXT_ISR_ATTR_1 void addPacket(const unsigned int protocolNumber, const uint32_t id, const uint32_t usecNow);
+
+	/** ========================================================================== */
+	/** ========= Called from the application ==================================== */
+
+	/**
+	 * Set the tolerance of the burst times in percent of the interval, the
+	 * minimum guard time around the expected bursts, the number of
+	 * bursts that a locked source may miss in a row and the number of
+	 * longest intervals between the discovery windows. 0 disables the
+	 * discovery windows. A discovery window, that has been scheduled
+	 * already, is scheduled again.
+	 */
+	void configure(const unsigned percentTolerance, const uint32_t usecMinGuard, const uint8_t missesLimit,
+			const uint8_t discoveryIntervals) {
+		mPercentTolerance = percentTolerance;
+		mUsecMinGuard = usecMinGuard;
+		mMissesLimit = missesLimit;
+		mDiscoveryIntervals = discoveryIntervals;
+		mDiscoveryScheduled = false;
+	}
+
+	/** The bits of the first received value, that identify a source. */
+	inline uint32_t idMask() const {return mIdMask;}
+
+	/** Returns true, if edges between the reception windows are dropped. */
+	inline bool isGating() const {return mGating;}
+
+	/** The number of edges, that have been dropped between the reception windows. */
+	inline uint32_t gatedEdgesCount() const {return mGatedEdgesCount;}
+
+	inline size_t sourcesCount() const {return mSourcesCount;}
+	inline const PeriodicSource& sourceAt(const size_t index) const {return mSources[index];}
+
+	/**
+	 * Forget all sources, so that the receiver decodes all of the time
+	 * again. Must not run concurrently with the interrupt handler of the
+	 * receiver.
+	 */
+	void reset();
+
+	/**
+	 * Like reset(), but may be called while the receiver is running. The
+	 * receiver decodes all of the time immediately. The interrupt handler
+	 * forgets the sources, when it publishes the next packet.
+	 */
+	void requestReset() {
+		mResetRequested = true;
+		mGating = false;
+	}
+};
+
+/**
+ * A reception scheduler for up to SOURCES_COUNT periodic transmitters.
+ * Sources are told apart by the protocol number and the bits of the first
+ * received value, that are set in idMask. The default mask 0 tells sources
+ * apart by the protocol number only.
+ *
+ * Usage example:
+ *
+ * static RcSwitch::ReceptionScheduler<8> receptionScheduler(0xFFFF0000);
+ * ...
+ * rcSwitchReceiver.setReceptionScheduler(receptionScheduler);
+ * rcSwitchReceiver.begin(rxProtocolTable.toTimingSpecTable());
+ */
+template<size_t SOURCES_COUNT>
+class ReceptionScheduler : public ReceptionSchedulerBase {
+	PeriodicSource mSourcesStorage[SOURCES_COUNT];
+public:
+	ReceptionScheduler(const uint32_t idMask = 0)
+		: ReceptionSchedulerBase(mSourcesStorage, SOURCES_COUNT, idMask) {
+	}
+};
+
+} // namespace RcSwitch
+
+#endif /* RCSWITCH_RECEIVER_INTERNAL_RECEPTIONSCHEDULER_HPP_ */
@@ -0,0 +1,201 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#include "TimingSpecOptimizer.hpp"
+#include "TypeTraits.hpp"
+
+namespace RcSwitch {
+
+namespace {
+
+/**
+ * Calculate a time range the same way as makeTimingSpec does. Returns
+ * false, if the upper bound exceeds duration_t.
+ */
+bool toTimeRange(TimeRange& timeRange, const uint32_t usecClock, const unsigned multiple,
+		const unsigned percentTolerance) {
+	const uint32_t usecNominal = usecClock * multiple;
+	const uint32_t upperBound = usecNominal * (100 + percentTolerance) / 100;
+	if(upperBound > INT_TRAITS<duration_t>::MAX) {
+		return false;
+	}
+	timeRange.lowerBound = usecNominal * (100 - percentTolerance) / 100;
+	timeRange.upperBound = upperBound;
+	return true;
+}
+
+inline uint32_t overlapOf(const TimeRange& a, const TimeRange& b) {
+	const duration_t lowerBound = a.lowerBound > b.lowerBound ? a.lowerBound : b.lowerBound;
+	const duration_t upperBound = a.upperBound < b.upperBound ? a.upperBound : b.upperBound;
+	return lowerBound < upperBound ? upperBound - lowerBound : 0;
+}
+
+inline uint32_t centerOf(const ObservedRange& range) {
+	return (static_cast<uint32_t>(range.mMin) + range.mMax) / 2;
+}
+
+/** The properties of a combination, in the order of their priority. */
+struct Score {
+	uint32_t usecOverlap;
+	unsigned percentMinMargin;
+
+	bool isBetterThan(const Score& other) const {
+		if(usecOverlap != other.usecOverlap) {
+			return usecOverlap < other.usecOverlap;
+		}
+		return percentMinMargin > other.percentMinMargin;
+	}
+};
+
+} // anonymous namespace
+
+RxTimingSpec TimingSpecProposal::toRxTimingSpec(const unsigned int protocolNumber) const {
+	RxTimingSpec timingSpec = {protocolNumber, bInverseLevel, {{0, 0}, {0, 0}}, {{0, 0}, {0, 0}},
+			{{0, 0}, {0, 0}}, usecClock, nullptr};
+	for(size_t w = 0; w < TIMING_WINDOWS_COUNT; w++) {
+		const TIMING_WINDOW window = static_cast<TIMING_WINDOW>(w);
+		toTimeRange(timeRangeOf(timingSpec, window), usecClock, multiples[window], percentTolerance);
+	}
+	return timingSpec;
+}
+
+TimingSpecOptimizer::TimingSpecOptimizer(const RxTimingSpecTable& deployed)
+	: mDeployed(deployed), mPercentGuard(OPTIMIZER_DEFAULT_PERCENT_GUARD)
+	, mMaxPercentTolerance(OPTIMIZER_DEFAULT_MAX_PERCENT_TOLERANCE), mUsecMinClock(OPTIMIZER_DEFAULT_USEC_MIN_CLOCK) {
+}
+
+uint32_t TimingSpecOptimizer::usecOverlap(const RxTimingSpec& timingSpec, size_t& overlappingProtocolsCount) const {
+	uint32_t usecOverlap = 0;
+	overlappingProtocolsCount = 0;
+	for(size_t row = 0; row < mDeployed.size; row++) {
+		const RxTimingSpec& deployed = mDeployed.start[row];
+		if(deployed.bInverseLevel != timingSpec.bInverseLevel) {
+			continue;
+		}
+		if(overlapOf(deployed.synchronizationPulsePair.durationA, timingSpec.synchronizationPulsePair.durationA) == 0
+				|| overlapOf(deployed.synchronizationPulsePair.durationB, timingSpec.synchronizationPulsePair.durationB) == 0) {
+			continue;
+		}
+		for(size_t w = 0; w < TIMING_WINDOWS_COUNT; w++) {
+			const TIMING_WINDOW window = static_cast<TIMING_WINDOW>(w);
+			usecOverlap += overlapOf(timeRangeOf(deployed, window), timeRangeOf(timingSpec, window));
+		}
+		++overlappingProtocolsCount;
+	}
+	return usecOverlap;
+}
+
+bool TimingSpecOptimizer::optimize(const ObservedTiming& observed, const bool bInverseLevel,
+		TimingSpecProposal& proposal) const {
+	/* The observed durations plus guard margin, that must be covered. */
+	uint32_t lowestToCover[TIMING_WINDOWS_COUNT];
+	uint32_t highestToCover[TIMING_WINDOWS_COUNT];
+	uint32_t usecMaxClock = INT_TRAITS<duration_t>::MAX;
+	for(size_t w = 0; w < TIMING_WINDOWS_COUNT; w++) {
+		const ObservedRange& range = observed.mRanges[w];
+		if(range.isEmpty()) {
+			return false;
+		}
+		const uint32_t center = centerOf(range);
+		const uint32_t guard = center * mPercentGuard / 100;
+		lowestToCover[w] = range.mMin > guard ? range.mMin - guard : 0;
+		highestToCover[w] = static_cast<uint32_t>(range.mMax) + guard;
+		/* The shortest duration is a multiple of at least 1. */
+		if(center + guard < usecMaxClock) {
+			usecMaxClock = center + guard;
+		}
+	}
+
+	bool bFound = false;
+	Score best = {0, 0};
+	TimingSpecProposal candidate;
+	candidate.bInverseLevel = bInverseLevel;
+
+	/* Iterate downwards respectively upwards, so that a higher clock and a
+	 * lower tolerance win on equal score. */
+	for(uint32_t usecClock = usecMaxClock; usecClock >= mUsecMinClock && usecClock > 0; usecClock--) {
+		candidate.usecClock = usecClock;
+		bool bNominalFits = true;
+		for(size_t w = 0; w < TIMING_WINDOWS_COUNT; w++) {
+			const uint32_t center = centerOf(observed.mRanges[w]);
+			candidate.multiples[w] = (center + usecClock / 2) / usecClock;
+			/* The nominal duration must stay within the guard margin around the
+			 * observed center. Otherwise the time ranges would become lopsided. */
+			const uint32_t usecNominal = usecClock * candidate.multiples[w];
+			const uint32_t usecDeviation = usecNominal > center ? usecNominal - center : center - usecNominal;
+			bNominalFits = bNominalFits && 100 * usecDeviation <= center * mPercentGuard;
+		}
+		if(not bNominalFits) {
+			continue;
+		}
+
+		for(unsigned percentTolerance = 1; percentTolerance <= mMaxPercentTolerance; percentTolerance++) {
+			candidate.percentTolerance = percentTolerance;
+			RxTimingSpec timingSpec = {0, bInverseLevel, {{0, 0}, {0, 0}}, {{0, 0}, {0, 0}},
+					{{0, 0}, {0, 0}}, static_cast<duration_t>(usecClock), nullptr};
+			unsigned percentMinMargin = UINT16_MAX;
+			bool bFeasible = true;
+			for(size_t w = 0; w < TIMING_WINDOWS_COUNT && bFeasible; w++) {
+				const TIMING_WINDOW window = static_cast<TIMING_WINDOW>(w);
+				TimeRange& timeRange = timeRangeOf(timingSpec, window);
+				bFeasible = toTimeRange(timeRange, usecClock, candidate.multiples[w], percentTolerance)
+						&& timeRange.lowerBound <= lowestToCover[w]
+						&& timeRange.upperBound > highestToCover[w];
+				if(bFeasible) {
+					/* The distance of the observed durations to the closer bound
+					 * in percent of the nominal duration. The upper bound is exclusive. */
+					const ObservedRange& range = observed.mRanges[w];
+					const uint32_t usecLowerMargin = range.mMin - timeRange.lowerBound;
+					const uint32_t usecUpperMargin = timeRange.upperBound - 1 - range.mMax;
+					const uint32_t usecMargin = usecLowerMargin < usecUpperMargin ? usecLowerMargin : usecUpperMargin;
+					const unsigned percentMargin = 100 * usecMargin / (usecClock * candidate.multiples[w]);
+					if(percentMargin < percentMinMargin) {
+						percentMinMargin = percentMargin;
+					}
+				}
+			}
+			/* Data 0 and data 1 must be distinguishable. */
+			bFeasible = bFeasible
+					&& overlapOf(timingSpec.data0pulsePair.durationA, timingSpec.data1pulsePair.durationA) == 0
+					&& overlapOf(timingSpec.data0pulsePair.durationB, timingSpec.data1pulsePair.durationB) == 0;
+			if(not bFeasible) {
+				continue;
+			}
+
+			size_t overlappingProtocolsCount = 0;
+			const Score score = {usecOverlap(timingSpec, overlappingProtocolsCount), percentMinMargin};
+			if(not bFound || score.isBetterThan(best)) {
+				bFound = true;
+				best = score;
+				candidate.usecOverlap = score.usecOverlap;
+				candidate.overlappingProtocolsCount = overlappingProtocolsCount;
+				proposal = candidate;
+			}
+		}
+	}
+	return bFound;
+}
+
+} // namespace RcSwitch
@@ -0,0 +1,126 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_INTERNAL_TIMINGSPECOPTIMIZER_HPP_
+#define RCSWITCH_RECEIVER_INTERNAL_TIMINGSPECOPTIMIZER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ProtocolTimingSpec.hpp"
+#include "TimingTuner.hpp"
+
+namespace RcSwitch {
+
+/** Default guard margin in percent of the observed pulse duration. */
+static constexpr unsigned OPTIMIZER_DEFAULT_PERCENT_GUARD = 5;
+
+/** Default highest tolerance. It is the one of the pulse analyzer. */
+static constexpr unsigned OPTIMIZER_DEFAULT_MAX_PERCENT_TOLERANCE = 20;
+
+/** Default lowest clock. It is the one of the fixed clock proposal. */
+static constexpr uint16_t OPTIMIZER_DEFAULT_USEC_MIN_CLOCK = 10;
+
+/**
+ * A timing specification, that is expressed by the template parameters
+ * of makeTimingSpec. The multiples are given per time range in the order
+ * of TIMING_WINDOW.
+ */
+struct TimingSpecProposal {
+	uint16_t usecClock;
+	unsigned percentTolerance;
+	unsigned multiples[TIMING_WINDOWS_COUNT];
+	bool bInverseLevel;
+
+	/** Summed width of the time ranges, that overlap with deployed protocols. */
+	uint32_t usecOverlap;
+	/** Number of deployed protocols, that overlap with the proposal. */
+	size_t overlappingProtocolsCount;
+
+	/** Calculate the time ranges the same way as makeTimingSpec does. */
+	RxTimingSpec toRxTimingSpec(const unsigned int protocolNumber) const;
+};
+
+/**
+ * Proposes a timing specification for observed pulse durations, which fits
+ * into a protocol table that is already deployed.
+ *
+ * All combinations of clock and tolerance are tried. The multiples of the
+ * clock are the rounded observed durations. A combination is feasible, if
+ * the nominal durations are within a guard margin of the observed ones, if
+ * its time ranges cover the observed durations plus the guard margin, and
+ * if the time ranges of data 0 and data 1 do not overlap. The best combination
+ * is chosen in this order:
+ * 1) Least overlap with the time ranges of the deployed protocols.
+ * 2) Widest margin between the observed durations and the bounds of the
+ *    time ranges, in percent of the nominal duration. The narrowest time
+ *    range counts.
+ * 3) Highest clock.
+ * 4) Lowest tolerance.
+ *
+ * A deployed protocol can only become a competing candidate at runtime,
+ * if both of its synch time ranges overlap with the proposal. Hence the
+ * time ranges of other deployed protocols don't count as overlap.
+ */
+class TimingSpecOptimizer {
+	const RxTimingSpecTable mDeployed;
+	unsigned mPercentGuard;
+	unsigned mMaxPercentTolerance;
+	uint16_t mUsecMinClock;
+
+public:
+	TimingSpecOptimizer(const RxTimingSpecTable& deployed);
+
+	/**
+	 * Set the guard margin in percent of the observed pulse duration, the
+	 * highest tolerance that may be proposed and the lowest clock.
+	 */
+	void configure(const unsigned percentGuard, const unsigned maxPercentTolerance,
+			const uint16_t usecMinClock) {
+		mPercentGuard = percentGuard;
+		mMaxPercentTolerance = maxPercentTolerance;
+		mUsecMinClock = usecMinClock;
+	}
+
+	/**
+	 * Return the summed width of the time ranges of the timing spec, that
+	 * overlap with the deployed protocols of the same level.
+	 */
+	uint32_t usecOverlap(const RxTimingSpec& timingSpec, size_t& overlappingProtocolsCount) const;
+
+	/**
+	 * Search for the best timing spec for the observed pulse durations.
+	 * Returns false, if the observation is incomplete or there is no
+	 * feasible combination.
+	 */
+	bool optimize(const ObservedTiming& observed, const bool bInverseLevel,
+			TimingSpecProposal& proposal) const;
+};
+
+} // namespace RcSwitch
+
+#endif /* RCSWITCH_RECEIVER_INTERNAL_TIMINGSPECOPTIMIZER_HPP_ */
@@ -0,0 +1,109 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#include "TimingTuner.hpp"
+
+namespace RcSwitch {
+
+/** Default guard margin in percent of the observed pulse duration. */
+static constexpr unsigned DEFAULT_PERCENT_GUARD = 10;
+
+/** Default number of packets before the time ranges of a protocol are narrowed. */
+static constexpr uint16_t DEFAULT_MIN_PACKETS = 3;
+
+TimingTunerBase::TimingTunerBase(const RxTimingSpecTable& original, RxTimingSpec* shadow, ObservedTiming* observed)
+	: mOriginal(original.start), mShadow(shadow), mObserved(observed), mRowCount(original.size)
+	, mUpdatePending(false), mPercentGuard(DEFAULT_PERCENT_GUARD), mMinPackets(DEFAULT_MIN_PACKETS) {
+	mPacket.clear();
+}
+
+void TimingTunerBase::clear() {
+	for(size_t row = 0; row < mRowCount; row++) {
+		mShadow[row] = mOriginal[row];
+		mObserved[row].clear();
+	}
+	mPacket.clear();
+	mUpdatePending = false;
+}
+
+void TimingTunerBase::tuneRow(const size_t row) {
+	const ObservedTiming& observed = mObserved[row];
+	if(observed.mPacketsCount < mMinPackets) {
+		return;
+	}
+	RxTimingSpec original = mOriginal[row];
+	RxTimingSpec& shadow = mShadow[row];
+	for(size_t w = 0; w < TIMING_WINDOWS_COUNT; w++) {
+		const TIMING_WINDOW window = static_cast<TIMING_WINDOW>(w);
+		const ObservedRange& range = observed.mRanges[window];
+		if(range.isEmpty()) {
+			continue;
+		}
+		const TimeRange& originalRange = timeRangeOf(original, window);
+		TimeRange& shadowRange = timeRangeOf(shadow, window);
+
+		const uint32_t center = (static_cast<uint32_t>(range.mMin) + range.mMax) / 2;
+		const uint32_t guard = center * mPercentGuard / 100;
+
+		/* The upper bound is exclusive. */
+		const uint32_t lowerBound = range.mMin > guard ? range.mMin - guard : 0;
+		const uint32_t upperBound = static_cast<uint32_t>(range.mMax) + guard + 1;
+
+		const duration_t tunedLowerBound = lowerBound > originalRange.lowerBound ? lowerBound : originalRange.lowerBound;
+		const duration_t tunedUpperBound = upperBound < originalRange.upperBound ? upperBound : originalRange.upperBound;
+		if(tunedLowerBound < tunedUpperBound) {
+			shadowRange.lowerBound = tunedLowerBound;
+			shadowRange.upperBound = tunedUpperBound;
+		}
+	}
+}
+
+bool TimingTunerBase::update() {
+	if(not mUpdatePending) {
+		return false;
+	}
+	mUpdatePending = false;
+
+	/* Iterate backwards, so that the synch pulse A lower bound of the
+	 * next row is final, when the current row is clamped against it. */
+	size_t row = mRowCount;
+	while(row > 0) {
+		--row;
+		tuneRow(row);
+		/* The receiver requires the rows of a protocol group to be sorted
+		 * in ascending order of the synch pulse A lower bound. */
+		const size_t next = row + 1;
+		if(next < mRowCount && mShadow[next].bInverseLevel == mShadow[row].bInverseLevel) {
+			TimeRange& synchA = mShadow[row].synchronizationPulsePair.durationA;
+			const duration_t nextLowerBound = mShadow[next].synchronizationPulsePair.durationA.lowerBound;
+			if(synchA.lowerBound > nextLowerBound) {
+				synchA.lowerBound = nextLowerBound;
+			}
+		}
+	}
+	return true;
+}
+
+} // namespace RcSwitch
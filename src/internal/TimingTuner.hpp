@@ -0,0 +1,235 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_INTERNAL_TIMINGTUNER_HPP_
+#define RCSWITCH_RECEIVER_INTERNAL_TIMINGTUNER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ISR_ATTR.hpp"
+#include "TypeTraits.hpp"
+#include "ProtocolTimingSpec.hpp"
+
+namespace RcSwitch {
+
+/** The time ranges of a RxTimingSpec. */
+enum TIMING_WINDOW : uint8_t {
+	SYNCH_A_WINDOW = 0,
+	SYNCH_B_WINDOW,
+	DATA0_A_WINDOW,
+	DATA0_B_WINDOW,
+	DATA1_A_WINDOW,
+	DATA1_B_WINDOW,
+	TIMING_WINDOWS_COUNT,
+};
+
+/** Return the time range of the timing spec, that corresponds to the window. */
+inline TimeRange& timeRangeOf(RxTimingSpec& timingSpec, const TIMING_WINDOW window) {
+	RxPulsePairTimeRanges* const pulsePairs[] = {
+			&timingSpec.synchronizationPulsePair, &timingSpec.data0pulsePair, &timingSpec.data1pulsePair};
+	RxPulsePairTimeRanges& pulsePair = *pulsePairs[window / 2];
+	return (window & 1) ? pulsePair.durationB : pulsePair.durationA;
+}
+
+inline const TimeRange& timeRangeOf(const RxTimingSpec& timingSpec, const TIMING_WINDOW window) {
+	return timeRangeOf(const_cast<RxTimingSpec&>(timingSpec), window);
+}
+
+/**
+ * The shortest and the longest pulse, that have been observed for a time
+ * range. Empty, as long as mMin is greater than mMax.
+ */
+struct ObservedRange {
+	duration_t mMin;
+	duration_t mMax;
+
+	TEXT_ISR_ATTR_2_INLINE void clear() {
+		mMin = INT_TRAITS<duration_t>::MAX;
+		mMax = 0;
+	}
+
+	TEXT_ISR_ATTR_2_INLINE void add(const duration_t usecDuration) {
+		if(usecDuration < mMin) {mMin = usecDuration;}
+		if(usecDuration > mMax) {mMax = usecDuration;}
+	}
+
+	TEXT_ISR_ATTR_2_INLINE void add(const ObservedRange& other) {
+		if(other.mMin < mMin) {mMin = other.mMin;}
+		if(other.mMax > mMax) {mMax = other.mMax;}
+	}
+
+	inline bool isEmpty() const {return mMin > mMax;}
+};
+
+/** The observed ranges of all time ranges of a protocol. */
+struct ObservedTiming {
+	ObservedRange mRanges[TIMING_WINDOWS_COUNT];
+	/** Number of packets, that contributed to the observed ranges. */
+	uint16_t mPacketsCount;
+
+	TEXT_ISR_ATTR_2_INLINE void clear() {
+		for(size_t i = 0; i < TIMING_WINDOWS_COUNT; i++) {
+			mRanges[i].clear();
+		}
+		mPacketsCount = 0;
+	}
+};
+
+/**
+ * Learns the pulse timing of the transmitters, that are actually received,
+ * and narrows the time ranges of the protocol table towards it. The
+ * receiver then works on a RAM shadow of the protocol table. That keeps
+ * the protocol candidate sets smaller and rejects noise earlier.
+ *
+ * The pulses of a message packet are collected while the packet is being
+ * received. They are merged into the statistics of a protocol, when the
+ * packet has been completed with exactly one protocol candidate left.
+ * Packets that match multiple protocols are ambiguous and hence ignored.
+ *
+ * Narrowed time ranges never exceed the time ranges of the original
+ * protocol table. A guard margin is kept around the observed pulse
+ * durations.
+ */
+class TimingTunerBase {
+	const RxTimingSpec* const mOriginal;
+	RxTimingSpec* const mShadow;
+	ObservedTiming* const mObserved;
+	const size_t mRowCount;
+
+	/** The pulses of the message packet that is currently being received. */
+	ObservedTiming mPacket;
+
+	/** Set by the interrupt handler, when new statistics are available. */
+	volatile bool mUpdatePending;
+
+	unsigned mPercentGuard;
+	uint16_t mMinPackets;
+
+	void tuneRow(const size_t row);
+
+protected:
+	TimingTunerBase(const RxTimingSpecTable& original, RxTimingSpec* shadow, ObservedTiming* observed);
+
+public:
+	/** ========================================================================== */
+	/** ========= Called from within interrupt context =========================== */
+
+	TEXT_ISR_ATTR_1_INLINE void restartPacket() {
+		mPacket.clear();
+	}
+
+	TEXT_ISR_ATTR_1_INLINE void addSynchPulses(const duration_t usecPulseA, const duration_t usecPulseB) {
+		mPacket.mRanges[SYNCH_A_WINDOW].add(usecPulseA);
+		mPacket.mRanges[SYNCH_B_WINDOW].add(usecPulseB);
+	}
+
+	TEXT_ISR_ATTR_1_INLINE void addDataPulses(const bool isLogical1, const duration_t usecPulseA, const duration_t usecPulseB) {
+		mPacket.mRanges[isLogical1 ? DATA1_A_WINDOW : DATA0_A_WINDOW].add(usecPulseA);
+		mPacket.mRanges[isLogical1 ? DATA1_B_WINDOW : DATA0_B_WINDOW].add(usecPulseB);
+	}
+
+	/**
+	 * Merge the pulses of the completed packet into the statistics of the
+	 * protocol, that the packet has been received with. The protocol is
+	 * given as row of the shadow table.
+	 */
+	TEXT_ISR_ATTR_1_INLINE void completePacket(const RxTimingSpec* protocol) {
+		const size_t row = protocol - mShadow;
+		if(row < mRowCount) {
+			ObservedTiming& observed = mObserved[row];
+			for(size_t i = 0; i < TIMING_WINDOWS_COUNT; i++) {
+				observed.mRanges[i].add(mPacket.mRanges[i]);
+			}
+			if(observed.mPacketsCount < UINT16_MAX) {
+				++observed.mPacketsCount;
+			}
+			mUpdatePending = true;
+		}
+		mPacket.clear();
+	}
+
+	/** ========================================================================== */
+	/** ========= Called from the application ==================================== */
+
+	/**
+	 * Set the guard margin in percent of the observed pulse duration, and
+	 * the number of packets, that a protocol must have been received with,
+	 * before its time ranges are narrowed.
+	 */
+	void configure(const unsigned percentGuard, const uint16_t minPackets) {
+		mPercentGuard = percentGuard;
+		mMinPackets = minPackets;
+	}
+
+	/** Return true, if packets have been completed since the last update(). */
+	inline bool isUpdatePending() const {return mUpdatePending;}
+
+	/**
+	 * Narrow the time ranges of the shadow table. Must not run concurrently
+	 * with the interrupt handler of the receiver. Returns true, if there
+	 * were new statistics.
+	 */
+	bool update();
+
+	/** Restore the original time ranges and forget all statistics. */
+	void clear();
+
+	const ObservedTiming& observedTiming(const size_t row) const {return mObserved[row];}
+
+	/** The shadow table, that the receiver must work with. */
+	RxTimingSpecTable toTimingSpecTable() const {return RxTimingSpecTable{mShadow, mRowCount};}
+};
+
+/**
+ * A timing tuner for a protocol table with ROW_COUNT rows.
+ *
+ * Usage example:
+ *
+ * static RcSwitch::TimingTuner<decltype(rxProtocolTable)::ROW_COUNT> timingTuner(
+ *     rxProtocolTable.toTimingSpecTable());
+ * ...
+ * rcSwitchReceiver.setTimingTuner(timingTuner);
+ * rcSwitchReceiver.begin(timingTuner.toTimingSpecTable());
+ * ...
+ * rcSwitchReceiver.tuneTimingSpec(); // from time to time in the loop
+ */
+template<size_t ROW_COUNT>
+class TimingTuner : public TimingTunerBase {
+	RxTimingSpec mShadowStorage[ROW_COUNT];
+	ObservedTiming mObservedStorage[ROW_COUNT];
+public:
+	TimingTuner(const RxTimingSpecTable& original)
+		: TimingTunerBase(RxTimingSpecTable{original.start, original.size < ROW_COUNT ? original.size : ROW_COUNT},
+				mShadowStorage, mObservedStorage) {
+		clear();
+	}
+};
+
+} // namespace RcSwitch
+
+#endif /* RCSWITCH_RECEIVER_INTERNAL_TIMINGTUNER_HPP_ */
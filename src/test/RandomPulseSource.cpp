@@ -0,0 +1,111 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#include "RandomPulseSource.hpp"
+#ifdef ENABLE_RCSWITCH_TEST
+
+#include "../internal/ProtocolTimingSpec.hpp"
+
+namespace RcSwitch {
+
+/** Highest number of data bits of a random message packet. */
+static constexpr size_t MAX_RANDOM_PACKET_BITS = 40;
+/** Highest number of repetitions of a random message packet. */
+static constexpr size_t MAX_RANDOM_PACKET_REPEATS = 4;
+
+RandomPulseSource::RandomPulseSource(const RxTimingSpecTable& rxTimingSpecTable, const uint32_t seed)
+	: mRxTimingSpecTable(rxTimingSpecTable), mRandomState(seed ? seed : 1), mPinLevel(0)
+	, mProtocol(nullptr), mRepeats(0), mPulseIndex(0), mBits(0), mBitsCount(0) {
+}
+
+uint32_t RandomPulseSource::random() {
+	/* xorshift32 */
+	uint32_t x = mRandomState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	mRandomState = x;
+	return x;
+}
+
+/**
+ * Return a duration within the time range most of the time. Otherwise the
+ * duration misses the time range by up to a quarter of the range width.
+ */
+uint32_t RandomPulseSource::distort(const uint32_t usecLowerBound, const uint32_t usecUpperBound) {
+	const uint32_t width = usecUpperBound - usecLowerBound;
+	const uint32_t r = random();
+	if(r % 16) {
+		return usecLowerBound + (r >> 4) % width;
+	}
+	const uint32_t lowest = usecLowerBound > width / 4 ? usecLowerBound - width / 4 : 1;
+	return lowest + (r >> 4) % (usecUpperBound + width / 4 - lowest);
+}
+
+void RandomPulseSource::startPacket() {
+	mProtocol = &mRxTimingSpecTable.start[random() % mRxTimingSpecTable.size];
+	mBitsCount = random() % (MAX_RANDOM_PACKET_BITS + 1);
+	mBits = random();
+	mRepeats = 1 + random() % MAX_RANDOM_PACKET_REPEATS;
+	mPulseIndex = 0;
+}
+
+bool RandomPulseSource::nextPulse(uint32_t& usecDuration, int& pinLevel) {
+	if(mProtocol == nullptr && mRxTimingSpecTable.size > 0 && (random() % 4) != 0) {
+		startPacket();
+	}
+
+	/* The pulse level is the pin level before the edge. */
+	const bool isHiPulse = mPinLevel;
+	if(mProtocol != nullptr && (mPulseIndex & 1) == 0 && isHiPulse == mProtocol->bInverseLevel) {
+		/* The first pulse of a pulse pair has the wrong level. Send noise to toggle it. */
+		usecDuration = 30 + random() % 15000;
+	} else if(mProtocol != nullptr) {
+		const size_t pairsPerRepeat = mBitsCount + 1;
+		const size_t pair = mPulseIndex / 2;
+		const size_t bitIndex = pair % pairsPerRepeat;
+		const RxPulsePairTimeRanges* pulsePair = &mProtocol->synchronizationPulsePair;
+		if(bitIndex != 0 && pair < mRepeats * pairsPerRepeat) {
+			const bool bit = (mBits >> ((bitIndex - 1) % 32)) & 1;
+			pulsePair = bit ? &mProtocol->data1pulsePair : &mProtocol->data0pulsePair;
+		}
+		const TimeRange& timeRange = (mPulseIndex & 1) ? pulsePair->durationB : pulsePair->durationA;
+		usecDuration = distort(timeRange.lowerBound, timeRange.upperBound);
+		if(++mPulseIndex == 2 * (mRepeats * pairsPerRepeat + 1)) {
+			/* The final synch pulse pair has been sent. */
+			mProtocol = nullptr;
+		}
+	} else {
+		usecDuration = 30 + random() % 15000;
+	}
+
+	mPinLevel = not mPinLevel;
+	pinLevel = mPinLevel;
+	return true;
+}
+
+} // namespace RcSwitch
+
+#endif // #ifdef ENABLE_RCSWITCH_TEST
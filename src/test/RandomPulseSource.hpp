@@ -0,0 +1,78 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_TEST_RANDOMPULSESOURCE_HPP_
+#define RCSWITCH_RECEIVER_TEST_RANDOMPULSESOURCE_HPP_
+
+#ifdef ENABLE_RCSWITCH_TEST
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "VirtualTime.hpp"
+#include "../internal/RxTimingSpecTable.hpp"
+
+namespace RcSwitch {
+
+/**
+ * A reproducible source of pulses, that mixes message packets of randomly
+ * chosen protocols from a timing spec table with noise. Packets have a
+ * random number of data bits and pulse durations are randomly distorted,
+ * so that pulses sometimes miss their time range. Pulse levels alternate
+ * like on a real IO pin.
+ * The random numbers are taken from a xorshift generator, so the same seed
+ * always yields the same pulses.
+ */
+class RandomPulseSource : public PulseSource {
+	const RxTimingSpecTable mRxTimingSpecTable;
+	uint32_t mRandomState;
+
+	/** The level of the IO pin after the last pulse. */
+	int mPinLevel;
+
+	/** The current message packet. mProtocol is nullptr between packets. */
+	const RxTimingSpec* mProtocol;
+	size_t mRepeats;
+	size_t mPulseIndex;
+	uint32_t mBits;
+	size_t mBitsCount;
+
+	uint32_t random();
+	uint32_t distort(const uint32_t usecLowerBound, const uint32_t usecUpperBound);
+	void startPacket();
+
+public:
+	RandomPulseSource(const RxTimingSpecTable& rxTimingSpecTable, const uint32_t seed);
+
+	bool nextPulse(uint32_t& usecDuration, int& pinLevel) override;
+};
+
+} // namespace RcSwitch
+
+#endif // #ifdef ENABLE_RCSWITCH_TEST
+
+#endif /* RCSWITCH_RECEIVER_TEST_RANDOMPULSESOURCE_HPP_ */
@@ -0,0 +1,395 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#include "RcSwitch_benchmark.hpp"
+#if defined(ENABLE_RCSWITCH_TEST) && not defined(ARDUINO)
+
+#include "RandomPulseSource.hpp"
+#include "TestFixtures.hpp"
+#include "ReceiverTestAccess.hpp"
+#include "../internal/MultiChannelReceiver.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+namespace RcSwitch {
+
+/** Call RcSwitch::RcSwitch_benchmark::theBenchmark.run() to execute benchmarks. */
+RcSwitch_benchmark RcSwitch_benchmark::theBenchmark;
+
+/** Number of channels of the multi channel receiver benchmark. */
+static constexpr size_t BENCHMARK_CHANNELS_COUNT = 8;
+
+static RcSwitch_benchmark::Edge benchmarkEdges[RcSwitch_benchmark::EDGES_COUNT];
+/** The CPU time of each edge, respectively of each batch of edges. */
+static uint64_t nsecEdges[RcSwitch_benchmark::EDGES_COUNT];
+
+namespace {
+
+inline uint64_t nsecNow() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+int compareDouble(const void* left, const void* right) {
+	const double a = *static_cast<const double*>(left);
+	const double b = *static_cast<const double*>(right);
+	if(a < b) return -1;
+	if(b < a) return 1;
+	return 0;
+}
+
+/** Sort the samples and return the median and the interquartile range. */
+void medianAndIqr(double* samples, const size_t count, double& median, double& iqr) {
+	qsort(samples, count, sizeof(double), compareDouble);
+	median = samples[count / 2];
+	iqr = samples[(3 * count) / 4] - samples[count / 4];
+}
+
+uint64_t worstOf(const uint64_t* nsecEdges, const size_t count) {
+	uint64_t nsecWorst = 0;
+	for(size_t i = 0; i < count; i++) {
+		if(nsecEdges[i] > nsecWorst) {
+			nsecWorst = nsecEdges[i];
+		}
+	}
+	return nsecWorst;
+}
+
+/**
+ * Fill the edges with the pulses of channelsCount random pulse sources.
+ * The edges of the channels are interleaved.
+ */
+void generateEdges(RcSwitch_benchmark::Edge* edges, const size_t count,
+		const RxTimingSpecTable& rxTimingSpecTable, const size_t channelsCount) {
+	RandomPulseSource* pulseSources[BENCHMARK_CHANNELS_COUNT];
+	uint32_t usecEdges[BENCHMARK_CHANNELS_COUNT] = {};
+	for(size_t c = 0; c < channelsCount; c++) {
+		pulseSources[c] = new RandomPulseSource(rxTimingSpecTable, 4711 + c);
+	}
+	for(size_t i = 0; i < count; i++) {
+		const size_t c = i % channelsCount;
+		uint32_t usecDuration = 0;
+		int pinLevel = 0;
+		pulseSources[c]->nextPulse(usecDuration, pinLevel);
+		usecEdges[c] += usecDuration;
+		edges[i].mUsec = usecEdges[c];
+		edges[i].mPinLevel = pinLevel;
+	}
+	for(size_t c = 0; c < channelsCount; c++) {
+		delete pulseSources[c];
+	}
+}
+
+class CountingPacketSink : public MultiChannelPacketSink {
+public:
+	size_t mPacketsCount = 0;
+	void onPacket(const size_t, const MultiChannelPacket&) override {
+		++mPacketsCount;
+	}
+};
+
+} // anonymous namespace
+
+void BenchmarkResult::setName(const char* benchmark, const char* table) {
+	strncpy(mBenchmark, benchmark, NAME_SIZE - 1);
+	mBenchmark[NAME_SIZE - 1] = '\0';
+	strncpy(mTable, table, NAME_SIZE - 1);
+	mTable[NAME_SIZE - 1] = '\0';
+}
+
+bool BenchmarkResult::hasName(const char* benchmark, const char* table) const {
+	return strcmp(mBenchmark, benchmark) == 0 && strcmp(mTable, table) == 0;
+}
+
+bool BenchmarkBaseline::load(const char* path) {
+	mSize = 0;
+	FILE* const file = fopen(path, "r");
+	if(not file) {
+		return false;
+	}
+	bool bVersionOk = false;
+	char line[160];
+	while(fgets(line, sizeof(line), file)) {
+		if(line[0] == '#' || line[0] == '\n') {
+			continue;
+		}
+		unsigned version = 0;
+		if(sscanf(line, "version %u", &version) == 1) {
+			bVersionOk = version == BENCHMARK_BASELINE_VERSION;
+			continue;
+		}
+		if(not bVersionOk) {
+			break;
+		}
+		BenchmarkResult result;
+		char benchmark[BenchmarkResult::NAME_SIZE];
+		char table[BenchmarkResult::NAME_SIZE];
+		if(sscanf(line, "%23s %23s %lf %lf %u %lf %u", benchmark, table,
+				&result.mNsecPerEdgeMedian, &result.mNsecPerEdgeIqr, &result.mPacketsPerSecond,
+				&result.mNsecWorstEdge, &result.mBytesMemory) == 7) {
+			result.setName(benchmark, table);
+			add(result);
+		}
+	}
+	fclose(file);
+	if(not bVersionOk) {
+		mSize = 0;
+	}
+	return bVersionOk;
+}
+
+bool BenchmarkBaseline::save(const char* path) const {
+	FILE* const file = fopen(path, "w");
+	if(not file) {
+		return false;
+	}
+	fprintf(file, "# RcSwitchReceiver decoder benchmark baseline\n");
+	fprintf(file, "version %u\n", BENCHMARK_BASELINE_VERSION);
+	fprintf(file, "# benchmark table ns/edge-median ns/edge-IQR packets/s worst-ns/edge bytes\n");
+	for(size_t i = 0; i < mSize; i++) {
+		const BenchmarkResult& result = mResults[i];
+		fprintf(file, "%s %s %.2f %.2f %u %.2f %u\n", result.mBenchmark, result.mTable,
+				result.mNsecPerEdgeMedian, result.mNsecPerEdgeIqr, result.mPacketsPerSecond,
+				result.mNsecWorstEdge, result.mBytesMemory);
+	}
+	return fclose(file) == 0;
+}
+
+void BenchmarkBaseline::add(const BenchmarkResult& result) {
+	if(mSize < CAPACITY) {
+		mResults[mSize++] = result;
+	}
+}
+
+const BenchmarkResult* BenchmarkBaseline::find(const char* benchmark, const char* table) const {
+	for(size_t i = 0; i < mSize; i++) {
+		if(mResults[i].hasName(benchmark, table)) {
+			return &mResults[i];
+		}
+	}
+	return nullptr;
+}
+
+void RcSwitch_benchmark::measureReceiver(BenchmarkResult& result, const RxTimingSpecTable& rxTimingSpecTable,
+		const Edge* edges) const {
+	double nsecPerEdge[REPEATS];
+	size_t packetsCount = 0;
+
+	for(size_t r = 0; r < REPEATS; r++) {
+		TestReceiver receiver;
+		ReceiverTestAccess::setRxTimingSpecTable(receiver, rxTimingSpecTable);
+		packetsCount = 0;
+		const uint64_t nsecStart = nsecNow();
+		for(size_t i = 0; i < EDGES_COUNT; i++) {
+			ReceiverTestAccess::handleInterrupt(receiver, edges[i].mPinLevel, edges[i].mUsec);
+			if(receiver.available()) {
+				++packetsCount;
+				receiver.resetAvailable();
+			}
+		}
+		nsecPerEdge[r] = static_cast<double>(nsecNow() - nsecStart) / EDGES_COUNT;
+	}
+
+	/* Time each edge in separate runs, because reading the clock per edge
+	 * distorts the time per edge. Interrupts of the host only add time, so
+	 * the cheapest run of each edge is taken. */
+	for(size_t r = 0; r < REPEATS; r++) {
+		TestReceiver receiver;
+		ReceiverTestAccess::setRxTimingSpecTable(receiver, rxTimingSpecTable);
+		for(size_t i = 0; i < EDGES_COUNT; i++) {
+			const uint64_t nsecStart = nsecNow();
+			ReceiverTestAccess::handleInterrupt(receiver, edges[i].mPinLevel, edges[i].mUsec);
+			const uint64_t nsec = nsecNow() - nsecStart;
+			if(r == 0 || nsec < nsecEdges[i]) {
+				nsecEdges[i] = nsec;
+			}
+			receiver.resetAvailable();
+		}
+	}
+
+	medianAndIqr(nsecPerEdge, REPEATS, result.mNsecPerEdgeMedian, result.mNsecPerEdgeIqr);
+	result.mNsecWorstEdge = worstOf(nsecEdges, EDGES_COUNT);
+	result.mPacketsPerSecond = packetsCount * 1e9 / (result.mNsecPerEdgeMedian * EDGES_COUNT);
+	result.mBytesMemory = sizeof(Receiver);
+}
+
+void RcSwitch_benchmark::measureMultiChannelReceiver(BenchmarkResult& result, const RxTimingSpecTable& rxTimingSpecTable,
+		const Edge* edges) const {
+	constexpr size_t STEPS_COUNT = EDGES_COUNT / BENCHMARK_CHANNELS_COUNT;
+	static uint32_t usecEdges[EDGES_COUNT];
+	static uint8_t pinLevels[EDGES_COUNT];
+	for(size_t i = 0; i < EDGES_COUNT; i++) {
+		usecEdges[i] = edges[i].mUsec;
+		pinLevels[i] = edges[i].mPinLevel;
+	}
+
+	double nsecPerEdge[REPEATS];
+	size_t packetsCount = 0;
+
+	for(size_t r = 0; r < REPEATS; r++) {
+		CountingPacketSink packetSink;
+		MultiChannelReceiver<BENCHMARK_CHANNELS_COUNT>* const receiver = new MultiChannelReceiver<BENCHMARK_CHANNELS_COUNT>;
+		receiver->setRxTimingSpecTable(rxTimingSpecTable);
+		receiver->setPacketSink(&packetSink);
+		const uint64_t nsecStart = nsecNow();
+		for(size_t s = 0; s < STEPS_COUNT; s++) {
+			const size_t i = s * BENCHMARK_CHANNELS_COUNT;
+			receiver->handleEdges(0, BENCHMARK_CHANNELS_COUNT, &usecEdges[i], &pinLevels[i]);
+		}
+		nsecPerEdge[r] = static_cast<double>(nsecNow() - nsecStart) / (STEPS_COUNT * BENCHMARK_CHANNELS_COUNT);
+		packetsCount = packetSink.mPacketsCount;
+		delete receiver;
+	}
+
+	/* The worst edge is the worst batch, shared by the edges of the batch.
+	 * The cheapest run of each batch is taken, like for the receiver. */
+	for(size_t r = 0; r < REPEATS; r++) {
+		CountingPacketSink packetSink;
+		MultiChannelReceiver<BENCHMARK_CHANNELS_COUNT>* const receiver = new MultiChannelReceiver<BENCHMARK_CHANNELS_COUNT>;
+		receiver->setRxTimingSpecTable(rxTimingSpecTable);
+		receiver->setPacketSink(&packetSink);
+		for(size_t s = 0; s < STEPS_COUNT; s++) {
+			const size_t i = s * BENCHMARK_CHANNELS_COUNT;
+			const uint64_t nsecStart = nsecNow();
+			receiver->handleEdges(0, BENCHMARK_CHANNELS_COUNT, &usecEdges[i], &pinLevels[i]);
+			const uint64_t nsec = nsecNow() - nsecStart;
+			if(r == 0 || nsec < nsecEdges[s]) {
+				nsecEdges[s] = nsec;
+			}
+		}
+		delete receiver;
+	}
+
+	medianAndIqr(nsecPerEdge, REPEATS, result.mNsecPerEdgeMedian, result.mNsecPerEdgeIqr);
+	result.mNsecWorstEdge = worstOf(nsecEdges, STEPS_COUNT) / BENCHMARK_CHANNELS_COUNT;
+	result.mPacketsPerSecond = packetsCount * 1e9 / (result.mNsecPerEdgeMedian * STEPS_COUNT * BENCHMARK_CHANNELS_COUNT);
+	result.mBytesMemory = sizeof(MultiChannelReceiver<BENCHMARK_CHANNELS_COUNT>);
+}
+
+bool RcSwitch_benchmark::compare(const BenchmarkResult& result, const BenchmarkBaseline& baseline) const {
+	printf("%-12s %-12s %8.2f %7.2f %10u %9.2f %7u  ", result.mBenchmark, result.mTable,
+			result.mNsecPerEdgeMedian, result.mNsecPerEdgeIqr, result.mPacketsPerSecond,
+			result.mNsecWorstEdge, result.mBytesMemory);
+
+	const BenchmarkResult* const base = baseline.find(result.mBenchmark, result.mTable);
+	if(not base) {
+		printf("new\n");
+		return false;
+	}
+
+	/* The noise of either run counts. Exceeding either threshold is a regression. */
+	const double nsecIqr = result.mNsecPerEdgeIqr > base->mNsecPerEdgeIqr ? result.mNsecPerEdgeIqr : base->mNsecPerEdgeIqr;
+	const double nsecNoise = IQR_REGRESSION_FACTOR * nsecIqr;
+	const double nsecRelative = base->mNsecPerEdgeMedian * PERCENT_REGRESSION_THRESHOLD / 100;
+	const double nsecThreshold = base->mNsecPerEdgeMedian + (nsecNoise < nsecRelative ? nsecNoise : nsecRelative);
+	const double nsecWorstThreshold = base->mNsecWorstEdge * (100 + PERCENT_WORST_EDGE_REGRESSION_THRESHOLD) / 100;
+
+	bool bRegression = false;
+	if(result.mNsecPerEdgeMedian > nsecThreshold) {
+		printf("REGRESSION ns/edge (baseline %.2f) ", base->mNsecPerEdgeMedian);
+		bRegression = true;
+	}
+	if(result.mNsecWorstEdge > nsecWorstThreshold) {
+		printf("REGRESSION worst edge (baseline %.2f) ", base->mNsecWorstEdge);
+		bRegression = true;
+	}
+	if(result.mBytesMemory > base->mBytesMemory) {
+		printf("REGRESSION memory (baseline %u) ", base->mBytesMemory);
+		bRegression = true;
+	}
+	if(not bRegression) {
+		printf("ok (baseline %.2f)", base->mNsecPerEdgeMedian);
+	}
+	printf("\n");
+	return bRegression;
+}
+
+size_t RcSwitch_benchmark::run(const char* baselinePath, const bool bUpdateBaseline) const {
+	const Table tables[] = {
+		{"rcswitch", rcSwitchProtocolTable.toTimingSpecTable()},
+		{"pt2262", pt2262ProtocolTable.toTimingSpecTable()},
+	};
+	constexpr size_t TABLES_COUNT = sizeof(tables) / sizeof(tables[0]);
+
+	BenchmarkBaseline baseline;
+	if(not baseline.load(baselinePath)) {
+		printf("No baseline of version %u in %s\n", BENCHMARK_BASELINE_VERSION, baselinePath);
+	}
+
+	printf("%-12s %-12s %8s %7s %10s %9s %7s  %s\n", "benchmark", "table",
+			"ns/edge", "IQR", "packets/s", "worst ns", "bytes", "verdict");
+
+	BenchmarkBaseline current;
+	size_t regressionsCount = 0;
+	size_t tableRegressionsCount[TABLES_COUNT] = {};
+	for(size_t t = 0; t < TABLES_COUNT; t++) {
+		const Table& table = tables[t];
+		BenchmarkResult result;
+
+		/* Packets mixed with noise. */
+		generateEdges(benchmarkEdges, EDGES_COUNT, table.mRxTimingSpecTable, 1);
+		result.setName("receiver", table.mName);
+		measureReceiver(result, table.mRxTimingSpecTable, benchmarkEdges);
+		current.add(result);
+		tableRegressionsCount[t] += compare(result, baseline);
+
+		/* Noise only. That's what the receiver is busy with most of the time. */
+		generateEdges(benchmarkEdges, EDGES_COUNT, RxTimingSpecTable{nullptr, 0}, 1);
+		result.setName("noise", table.mName);
+		measureReceiver(result, table.mRxTimingSpecTable, benchmarkEdges);
+		current.add(result);
+		tableRegressionsCount[t] += compare(result, baseline);
+
+		generateEdges(benchmarkEdges, EDGES_COUNT, table.mRxTimingSpecTable, BENCHMARK_CHANNELS_COUNT);
+		result.setName("multichannel", table.mName);
+		measureMultiChannelReceiver(result, table.mRxTimingSpecTable, benchmarkEdges);
+		current.add(result);
+		tableRegressionsCount[t] += compare(result, baseline);
+
+		regressionsCount += tableRegressionsCount[t];
+	}
+
+	for(size_t t = 0; t < TABLES_COUNT; t++) {
+		printf("Protocol table %s: %u regression(s)\n", tables[t].mName,
+				static_cast<unsigned>(tableRegressionsCount[t]));
+	}
+
+	if(bUpdateBaseline) {
+		if(current.save(baselinePath)) {
+			printf("Baseline written to %s\n", baselinePath);
+		} else {
+			printf("Failed to write baseline to %s\n", baselinePath);
+		}
+	}
+	return regressionsCount;
+}
+
+} // namespace RcSwitch
+
+#endif // #if defined(ENABLE_RCSWITCH_TEST) && not defined(ARDUINO)
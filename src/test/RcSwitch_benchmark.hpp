@@ -0,0 +1,169 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_TEST_RCSWITCH_BENCHMARK_HPP_
+#define RCSWITCH_RECEIVER_TEST_RCSWITCH_BENCHMARK_HPP_
+
+/**
+ * The benchmarks measure host CPU time. They are only available, when the
+ * tests are built on a host, not for an Arduino board.
+ */
+#if defined(ENABLE_RCSWITCH_TEST) && not defined(ARDUINO)
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "TestFixtures.hpp"
+#include "../internal/RxTimingSpecTable.hpp"
+
+namespace RcSwitch {
+
+/** Version of the baseline file format. Increment on format changes. */
+static constexpr unsigned BENCHMARK_BASELINE_VERSION = 1;
+
+/**
+ * The result of a benchmark with a particular protocol table.
+ */
+struct BenchmarkResult {
+	static constexpr size_t NAME_SIZE = 24;
+
+	char mBenchmark[NAME_SIZE];
+	char mTable[NAME_SIZE];
+
+	/** Median and interquartile range of the CPU time per edge over all runs. */
+	double mNsecPerEdgeMedian;
+	double mNsecPerEdgeIqr;
+	/** Packets decoded per second of CPU time. */
+	uint32_t mPacketsPerSecond;
+	/** The most expensive edge. Each edge counts with its cheapest run. */
+	double mNsecWorstEdge;
+	/** RAM of the decoder. */
+	uint32_t mBytesMemory;
+
+	void setName(const char* benchmark, const char* table);
+	bool hasName(const char* benchmark, const char* table) const;
+};
+
+/**
+ * A set of benchmark results, that is stored in a text file. The file
+ * starts with the format version. Each further line holds one result:
+ *
+ * # comment
+ * version 1
+ * <benchmark> <table> <ns/edge median> <ns/edge IQR> <packets/s> <worst ns/edge> <bytes>
+ */
+class BenchmarkBaseline {
+public:
+	static constexpr size_t CAPACITY = 16;
+
+private:
+	BenchmarkResult mResults[CAPACITY];
+	size_t mSize;
+
+public:
+	BenchmarkBaseline() : mSize(0) {}
+
+	/**
+	 * Load a baseline file. Returns false, if the file can not be read or
+	 * has a different format version.
+	 */
+	bool load(const char* path);
+	bool save(const char* path) const;
+
+	void add(const BenchmarkResult& result);
+	const BenchmarkResult* find(const char* benchmark, const char* table) const;
+
+	inline size_t size() const {return mSize;}
+	inline const BenchmarkResult& at(const size_t i) const {return mResults[i];}
+};
+
+/**
+ * Runs the decoder benchmarks with all benchmark protocol tables. Each
+ * benchmark is repeated several times. The median and the interquartile
+ * range of the runs are compared against the baseline. A benchmark has
+ * regressed, if:
+ * - its median CPU time per edge exceeds the baseline median by more than
+ *   PERCENT_REGRESSION_THRESHOLD, or
+ * - its median CPU time per edge exceeds the baseline median by more than
+ *   IQR_REGRESSION_FACTOR times the larger interquartile range of both, or
+ * - its worst edge exceeds the baseline by more than
+ *   PERCENT_WORST_EDGE_REGRESSION_THRESHOLD, or
+ * - its memory grew.
+ *
+ * The reference baseline is test/RcSwitch_benchmark_baseline.txt. It has
+ * been recorded on an x86-64 Linux host with gcc -O2. Record a baseline of
+ * your own, when comparing on a different host.
+ *
+ * Usage example on a Linux host, with the library compiled with
+ * ENABLE_RCSWITCH_TEST defined:
+ *
+ * int main(int argc, char* argv[]) {
+ *     const bool bUpdateBaseline = argc > 2;
+ *     return RcSwitch::RcSwitch_benchmark::theBenchmark.run(argv[1], bUpdateBaseline) ? 1 : 0;
+ * }
+ */
+class RcSwitch_benchmark {
+public:
+	static constexpr size_t REPEATS = 9;
+	static constexpr size_t EDGES_COUNT = 20000;
+
+	static constexpr unsigned PERCENT_REGRESSION_THRESHOLD = 10;
+	static constexpr unsigned IQR_REGRESSION_FACTOR = 3;
+	static constexpr unsigned PERCENT_WORST_EDGE_REGRESSION_THRESHOLD = 100;
+
+	typedef TestEdge Edge;
+
+private:
+	struct Table {
+		const char* mName;
+		RxTimingSpecTable mRxTimingSpecTable;
+	};
+
+	void measureReceiver(BenchmarkResult& result, const RxTimingSpecTable& rxTimingSpecTable,
+			const Edge* edges) const;
+	void measureMultiChannelReceiver(BenchmarkResult& result, const RxTimingSpecTable& rxTimingSpecTable,
+			const Edge* edges) const;
+
+	/** Compare against the baseline and print the verdict. Returns true on regression. */
+	bool compare(const BenchmarkResult& result, const BenchmarkBaseline& baseline) const;
+
+public:
+	/**
+	 * Run all benchmarks and compare them against the baseline file. If
+	 * bUpdateBaseline is set, the results are written to the baseline file
+	 * afterwards. Returns the number of regressions.
+	 */
+	size_t run(const char* baselinePath, const bool bUpdateBaseline) const;
+
+	static RcSwitch_benchmark theBenchmark;
+};
+
+} // namespace RcSwitch
+
+#endif // #if defined(ENABLE_RCSWITCH_TEST) && not defined(ARDUINO)
+
+#endif /* RCSWITCH_RECEIVER_TEST_RCSWITCH_BENCHMARK_HPP_ */
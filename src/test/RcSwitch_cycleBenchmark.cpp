@@ -0,0 +1,156 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#include "RcSwitch_cycleBenchmark.hpp"
+#if defined(ENABLE_RCSWITCH_TEST) && defined(__AVR__)
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#include "ReceiverTestAccess.hpp"
+
+namespace RcSwitch {
+
+/** Keeps the compiler from moving code across the timer readings. */
+#define RCSWITCH_CYCLE_BARRIER() asm volatile("" ::: "memory")
+
+bool RecordedPulseSource::nextPulse(uint32_t& usecDuration, int& pinLevel) {
+	if(mIndex == mDurationsCount) {
+		if(++mCycle >= mCyclesCount) {
+			return false;
+		}
+		mIndex = 0;
+	}
+	usecDuration = pgm_read_word(&mUsecDurations[mIndex]);
+	pinLevel = (mIndex & 1) ? not mFirstPulseEndLevel : mFirstPulseEndLevel;
+	++mIndex;
+	return true;
+}
+
+RcSwitch_cycleBenchmark::RcSwitch_cycleBenchmark()
+	: mCyclesOverhead(0), mPacketsCount(0) {
+	for(size_t s = 0; s < STATES_COUNT; s++) {
+		mStatistics[s].reset();
+	}
+}
+
+const char* RcSwitch_cycleBenchmark::stateName(const size_t state) {
+	switch(state) {
+	case ReceiverTestAccess::AVAILABLE_STATE: return "AVAILABLE";
+	case ReceiverTestAccess::SYNC_STATE: return "SYNC";
+	case ReceiverTestAccess::DATA_STATE: return "DATA";
+	}
+	return "?";
+}
+
+/** The cycles between two readings of the timer without a call in between. */
+uint16_t RcSwitch_cycleBenchmark::measureOverhead() {
+	const uint8_t sreg = SREG;
+	cli();
+	const uint16_t start = TCNT1;
+	RCSWITCH_CYCLE_BARRIER();
+	const uint16_t end = TCNT1;
+	SREG = sreg;
+	return end - start;
+}
+
+void RcSwitch_cycleBenchmark::run(const RxTimingSpecTable& rxTimingSpecTable,
+		PulseSource& pulseSource, const size_t edgesCount) {
+	for(size_t s = 0; s < STATES_COUNT; s++) {
+		mStatistics[s].reset();
+	}
+	mPacketsCount = 0;
+
+	const uint8_t tccr1a = TCCR1A;
+	const uint8_t tccr1b = TCCR1B;
+	/* Normal mode, no prescaler: Timer1 counts CPU cycles. */
+	TCCR1A = 0;
+	TCCR1B = _BV(CS10);
+	mCyclesOverhead = measureOverhead();
+
+	TestReceiver receiver;
+	ReceiverTestAccess::setRxTimingSpecTable(receiver, rxTimingSpecTable);
+	uint32_t usecEdge = 0;
+	size_t availableEdgesCount = 0;
+	for(size_t i = 0; i < edgesCount; i++) {
+		uint32_t usecDuration = 0;
+		int pinLevel = 0;
+		if(not pulseSource.nextPulse(usecDuration, pinLevel)) {
+			break;
+		}
+		usecEdge += usecDuration;
+		const size_t state = ReceiverTestAccess::state(receiver);
+
+		const uint8_t sreg = SREG;
+		cli();
+		const uint16_t start = TCNT1;
+		RCSWITCH_CYCLE_BARRIER();
+		ReceiverTestAccess::handleInterrupt(receiver, pinLevel, usecEdge);
+		RCSWITCH_CYCLE_BARRIER();
+		const uint16_t end = TCNT1;
+		SREG = sreg;
+
+		mStatistics[state].add(end - start - mCyclesOverhead);
+		if(receiver.available()) {
+			if(state != ReceiverTestAccess::AVAILABLE_STATE) {
+				++mPacketsCount;
+				availableEdgesCount = 0;
+			} else if(++availableEdgesCount == AVAILABLE_EDGES_COUNT) {
+				receiver.resetAvailable();
+			}
+		}
+	}
+
+	TCCR1A = tccr1a;
+	TCCR1B = tccr1b;
+}
+
+void RcSwitch_cycleBenchmark::dump(typeof(Serial)& stream, const char* tableName) const {
+	for(size_t s = 0; s < STATES_COUNT; s++) {
+		const CycleStatistics& statistics = mStatistics[s];
+		stream.print(tableName);
+		stream.print(' ');
+		stream.print(stateName(s));
+		stream.print(" calls=");
+		stream.print(statistics.mCallsCount);
+		if(statistics.mCallsCount) {
+			stream.print(" min=");
+			stream.print(statistics.mCyclesMin);
+			stream.print(" avg=");
+			stream.print(statistics.mCyclesSum / statistics.mCallsCount);
+			stream.print(" max=");
+			stream.print(statistics.mCyclesMax);
+		}
+		stream.println();
+	}
+	stream.print(tableName);
+	stream.print(" packets=");
+	stream.println(mPacketsCount);
+}
+
+} // namespace RcSwitch
+
+#endif // #if defined(ENABLE_RCSWITCH_TEST) && defined(__AVR__)
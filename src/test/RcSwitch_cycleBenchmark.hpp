@@ -0,0 +1,149 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_TEST_RCSWITCH_CYCLEBENCHMARK_HPP_
+#define RCSWITCH_RECEIVER_TEST_RCSWITCH_CYCLEBENCHMARK_HPP_
+
+/**
+ * The cycle benchmark counts CPU cycles with the 16 bit Timer1 of an AVR
+ * micro controller, e.g. the ATmega328P of the Arduino UNO. It is meant to
+ * be run on a cycle accurate AVR simulator, like simavr. Refer to example
+ * sketch BenchmarkAvrCycles.ino.
+ */
+#if defined(ENABLE_RCSWITCH_TEST) && defined(__AVR__)
+
+#include <stddef.h>
+#include <stdint.h>
+#include <Arduino.h>
+
+#include "VirtualTime.hpp"
+#include "../internal/RxTimingSpecTable.hpp"
+
+namespace RcSwitch {
+
+class Receiver;
+
+/**
+ * Provides pulses that have been recorded, e.g. with example sketch
+ * TraceReceivedPulses.ino. The pulse durations are stored in flash memory.
+ * The pin level alternates from pulse to pulse. The recording is repeated
+ * cyclesCount times.
+ */
+class RecordedPulseSource : public PulseSource {
+	const uint16_t* const mUsecDurations;
+	const size_t mDurationsCount;
+	const size_t mCyclesCount;
+	/** The pin level after the first pulse. */
+	const int mFirstPulseEndLevel;
+	size_t mCycle;
+	size_t mIndex;
+public:
+	RecordedPulseSource(const uint16_t* usecDurationsInFlash, const size_t durationsCount,
+			const int firstPulseEndLevel, const size_t cyclesCount = 1)
+		: mUsecDurations(usecDurationsInFlash), mDurationsCount(durationsCount)
+		, mCyclesCount(cyclesCount), mFirstPulseEndLevel(firstPulseEndLevel)
+		, mCycle(0), mIndex(0) {
+	}
+
+	bool nextPulse(uint32_t& usecDuration, int& pinLevel) override;
+};
+
+/**
+ * Cycle statistics of the interrupt handler calls, that started in a
+ * particular receiver state.
+ */
+struct CycleStatistics {
+	uint32_t mCallsCount;
+	uint32_t mCyclesSum;
+	uint16_t mCyclesMin;
+	uint16_t mCyclesMax;
+
+	void reset() {
+		mCallsCount = 0;
+		mCyclesSum = 0;
+		mCyclesMin = UINT16_MAX;
+		mCyclesMax = 0;
+	}
+
+	void add(const uint16_t cycles) {
+		++mCallsCount;
+		mCyclesSum += cycles;
+		if(cycles < mCyclesMin) {mCyclesMin = cycles;}
+		if(cycles > mCyclesMax) {mCyclesMax = cycles;}
+	}
+};
+
+/**
+ * Feeds the edges of a pulse source into the interrupt handler of a
+ * receiver and counts the CPU cycles of each Receiver::handleInterrupt()
+ * call. The cycles are accounted to the receiver state before the call.
+ *
+ * Timer1 runs without prescaler during the measurement, and interrupts
+ * are disabled around each call like within the interrupt context. The
+ * cycles of reading the timer are measured once and subtracted. So on a
+ * simulator the counts are exact and reproducible. On a board, the counts
+ * are exact as well, but the edges are not related to the IO pin.
+ *
+ * A received packet is reset after AVAILABLE_EDGES_COUNT further edges,
+ * like a sketch would pick it up from its loop function.
+ */
+class RcSwitch_cycleBenchmark {
+public:
+	/** Receiver::AVAILABLE_STATE, SYNC_STATE and DATA_STATE. */
+	static constexpr size_t STATES_COUNT = 3;
+	/** Number of edges, that arrive while a received packet is available. */
+	static constexpr size_t AVAILABLE_EDGES_COUNT = 4;
+
+private:
+	CycleStatistics mStatistics[STATES_COUNT];
+	uint16_t mCyclesOverhead;
+	uint16_t mPacketsCount;
+
+	static const char* stateName(const size_t state);
+	uint16_t measureOverhead();
+
+public:
+	RcSwitch_cycleBenchmark();
+
+	/**
+	 * Feed at most edgesCount edges of the pulse source into a receiver
+	 * that uses the timing spec table.
+	 */
+	void run(const RxTimingSpecTable& rxTimingSpecTable, PulseSource& pulseSource, const size_t edgesCount);
+
+	inline const CycleStatistics& statistics(const size_t state) const {return mStatistics[state];}
+	inline uint16_t packetsCount() const {return mPacketsCount;}
+
+	/** Print one line per receiver state. */
+	void dump(typeof(Serial)& stream, const char* tableName) const;
+};
+
+} // namespace RcSwitch
+
+#endif // #if defined(ENABLE_RCSWITCH_TEST) && defined(__AVR__)
+
+#endif /* RCSWITCH_RECEIVER_TEST_RCSWITCH_CYCLEBENCHMARK_HPP_ */
@@ -0,0 +1,348 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#include "RcSwitch_differential.hpp"
+#if defined(ENABLE_RCSWITCH_TEST) && not defined(ARDUINO)
+
+#include "RandomPulseSource.hpp"
+#include "TestFixtures.hpp"
+#include "ReceiverTestAccess.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+namespace RcSwitch {
+
+/** Call RcSwitch::RcSwitch_differential::theDifferential.run() to execute the differential tests. */
+RcSwitch_differential RcSwitch_differential::theDifferential;
+
+static RcSwitch_differential::Edge differentialEdges[RcSwitch_differential::EDGES_COUNT];
+
+namespace {
+
+inline uint64_t nsecNow() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+/** Sort the protocol numbers of a packet in ascending order. */
+void sortProtocols(unsigned int* protocolNumbers, const size_t count) {
+	for(size_t i = 1; i < count; i++) {
+		const unsigned int protocolNumber = protocolNumbers[i];
+		size_t j = i;
+		for(; j > 0 && protocolNumbers[j - 1] > protocolNumber; j--) {
+			protocolNumbers[j] = protocolNumbers[j - 1];
+		}
+		protocolNumbers[j] = protocolNumber;
+	}
+}
+
+DIVERGENCE comparePackets(const MultiChannelPacket& reference, const MultiChannelPacket& engine) {
+	if(reference.mBitsCount != engine.mBitsCount) {
+		return DIVERGENCE::BITS_COUNT;
+	}
+	if(reference.mValuesCount != engine.mValuesCount) {
+		return DIVERGENCE::VALUES;
+	}
+	for(size_t i = 0; i < reference.mValuesCount; i++) {
+		if(reference.mValues[i] != engine.mValues[i]) {
+			return DIVERGENCE::VALUES;
+		}
+	}
+	if(reference.mProtocolCount != engine.mProtocolCount) {
+		return DIVERGENCE::PROTOCOLS;
+	}
+	unsigned int referenceProtocols[MAX_PROTOCOL_CANDIDATES];
+	unsigned int engineProtocols[MAX_PROTOCOL_CANDIDATES];
+	memcpy(referenceProtocols, reference.mProtocolNumbers, sizeof(referenceProtocols));
+	memcpy(engineProtocols, engine.mProtocolNumbers, sizeof(engineProtocols));
+	sortProtocols(referenceProtocols, reference.mProtocolCount);
+	sortProtocols(engineProtocols, engine.mProtocolCount);
+	if(memcmp(referenceProtocols, engineProtocols, reference.mProtocolCount * sizeof(unsigned int)) != 0) {
+		return DIVERGENCE::PROTOCOLS;
+	}
+	return DIVERGENCE::NONE;
+}
+
+const char* divergenceToString(const DIVERGENCE divergence) {
+	switch(divergence) {
+	case DIVERGENCE::NONE: return "none";
+	case DIVERGENCE::PACKET: return "packet";
+	case DIVERGENCE::BITS_COUNT: return "bit count";
+	case DIVERGENCE::VALUES: return "values";
+	case DIVERGENCE::PROTOCOLS: return "protocols";
+	}
+	return "?";
+}
+
+/** Copy the available packet of a receiver and make it receive again. */
+template<typename T> void takePacket(T& receiver, MultiChannelPacket& packet) {
+	packet.mBitsCount = receiver.receivedBitsCount();
+	packet.mValuesCount = receiver.receivedValuesCount();
+	for(size_t i = 0; i < RCSWITCH_UINT32_ARRAY_SIZE; i++) {
+		packet.mValues[i] = i < packet.mValuesCount ? receiver.receivedValueAt(i) : 0;
+	}
+	packet.mProtocolCount = receiver.receivedProtocolCount();
+	for(size_t i = 0; i < packet.mProtocolCount; i++) {
+		packet.mProtocolNumbers[i] = receiver.receivedProtocol(i);
+	}
+	receiver.resetAvailable();
+}
+
+} // anonymous namespace
+
+void ReferenceEngine::begin(const RxTimingSpecTable& rxTimingSpecTable) {
+	mReceiver = ReferenceReceiver();
+	mReceiver.setRxTimingSpecTable(rxTimingSpecTable);
+}
+
+bool ReferenceEngine::handleEdge(const int pinLevel, const uint32_t usecEdge, MultiChannelPacket& packet) {
+	mReceiver.handleInterrupt(pinLevel, usecEdge);
+	if(mReceiver.available()) {
+		takePacket(mReceiver, packet);
+		return true;
+	}
+	return false;
+}
+
+void ReceiverEngine::begin(const RxTimingSpecTable& rxTimingSpecTable) {
+	/* The Receiver can't be assigned, because of its volatile members. */
+	delete mReceiver;
+	mReceiver = new TestReceiver;
+	ReceiverTestAccess::setRxTimingSpecTable(*mReceiver, rxTimingSpecTable);
+}
+
+bool ReceiverEngine::handleEdge(const int pinLevel, const uint32_t usecEdge, MultiChannelPacket& packet) {
+	ReceiverTestAccess::handleInterrupt(*mReceiver, pinLevel, usecEdge);
+	if(mReceiver->available()) {
+		takePacket(*mReceiver, packet);
+		return true;
+	}
+	return false;
+}
+
+void MultiChannelReceiverEngine::onPacket(const size_t, const MultiChannelPacket& packet) {
+	*mPacket = packet;
+	mbPacket = true;
+}
+
+void MultiChannelReceiverEngine::begin(const RxTimingSpecTable& rxTimingSpecTable) {
+	mReceiver = MultiChannelReceiver<1>();
+	mReceiver.setRxTimingSpecTable(rxTimingSpecTable);
+	mReceiver.setPacketSink(this);
+}
+
+bool MultiChannelReceiverEngine::handleEdge(const int pinLevel, const uint32_t usecEdge, MultiChannelPacket& packet) {
+	mPacket = &packet;
+	mbPacket = false;
+	mReceiver.handleEdge(0, pinLevel, usecEdge);
+	return mbPacket;
+}
+
+size_t RcSwitch_differential::generateEdges(Edge* edges, const size_t capacity, PulseSource& pulseSource) {
+	uint32_t usecEdge = 0;
+	size_t count = 0;
+	for(; count < capacity; count++) {
+		uint32_t usecDuration = 0;
+		int pinLevel = 0;
+		if(not pulseSource.nextPulse(usecDuration, pinLevel)) {
+			break;
+		}
+		usecEdge += usecDuration;
+		edges[count].mUsec = usecEdge;
+		edges[count].mPinLevel = pinLevel;
+	}
+	return count;
+}
+
+size_t RcSwitch_differential::loadEdges(Edge* edges, const size_t capacity, const char* path) {
+	FILE* const file = fopen(path, "r");
+	if(not file) {
+		return 0;
+	}
+	uint32_t usecEdge = 0;
+	size_t count = 0;
+	char line[160];
+	while(count < capacity && fgets(line, sizeof(line), file)) {
+		/* e.g. "[  0] HIGH for   350usec CPU interrupt load = ..." */
+		char level[8];
+		unsigned usecDuration = 0;
+		if(sscanf(line, " [%*u] %7s for %u", level, &usecDuration) == 2) {
+			usecEdge += usecDuration;
+			edges[count].mUsec = usecEdge;
+			/* The pin is low after a high pulse. */
+			edges[count].mPinLevel = strcmp(level, "HIGH") == 0 ? 0 : 1;
+			++count;
+		}
+	}
+	fclose(file);
+	return count;
+}
+
+uint64_t RcSwitch_differential::nsecRun(DecoderEngine& engine, const RxTimingSpecTable& rxTimingSpecTable,
+		const Edge* edges, const size_t count) {
+	uint64_t nsecBest = 0;
+	for(size_t r = 0; r < SPEED_REPEATS; r++) {
+		MultiChannelPacket packet;
+		engine.begin(rxTimingSpecTable);
+		const uint64_t nsecStart = nsecNow();
+		for(size_t i = 0; i < count; i++) {
+			engine.handleEdge(edges[i].mPinLevel, edges[i].mUsec, packet);
+		}
+		const uint64_t nsec = nsecNow() - nsecStart;
+		if(r == 0 || nsec < nsecBest) {
+			nsecBest = nsec;
+		}
+	}
+	return nsecBest;
+}
+
+bool RcSwitch_differential::compare(DecoderEngine& reference, DecoderEngine& engine,
+		const RxTimingSpecTable& rxTimingSpecTable, const Edge* edges, const size_t count,
+		DifferentialResult& result) {
+	result.mDivergence = DIVERGENCE::NONE;
+	result.mEdgeIndex = count;
+	result.mPacketsCount = 0;
+	result.mbReferencePacket = false;
+	result.mbEnginePacket = false;
+	result.mSpeedRatio = 0;
+
+	reference.begin(rxTimingSpecTable);
+	engine.begin(rxTimingSpecTable);
+	for(size_t i = 0; i < count; i++) {
+		const bool bReferencePacket = reference.handleEdge(edges[i].mPinLevel, edges[i].mUsec, result.mReferencePacket);
+		const bool bEnginePacket = engine.handleEdge(edges[i].mPinLevel, edges[i].mUsec, result.mEnginePacket);
+		DIVERGENCE divergence = DIVERGENCE::NONE;
+		if(bReferencePacket != bEnginePacket) {
+			divergence = DIVERGENCE::PACKET;
+		} else if(bReferencePacket) {
+			divergence = comparePackets(result.mReferencePacket, result.mEnginePacket);
+			if(divergence == DIVERGENCE::NONE) {
+				++result.mPacketsCount;
+			}
+		}
+		if(divergence != DIVERGENCE::NONE) {
+			result.mDivergence = divergence;
+			result.mEdgeIndex = i;
+			result.mbReferencePacket = bReferencePacket;
+			result.mbEnginePacket = bEnginePacket;
+			break;
+		}
+	}
+
+	const uint64_t nsecReference = nsecRun(reference, rxTimingSpecTable, edges, count);
+	const uint64_t nsecEngine = nsecRun(engine, rxTimingSpecTable, edges, count);
+	result.mSpeedRatio = nsecEngine ? static_cast<double>(nsecReference) / nsecEngine : 0;
+	return result.mDivergence != DIVERGENCE::NONE;
+}
+
+void RcSwitch_differential::printPacket(const char* name, const bool bPacket, const MultiChannelPacket& packet) {
+	printf("  %-12s", name);
+	if(not bPacket) {
+		printf("no packet\n");
+		return;
+	}
+	printf("%u bits, values", static_cast<unsigned>(packet.mBitsCount));
+	for(size_t i = 0; i < packet.mValuesCount; i++) {
+		printf(" 0x%08x", static_cast<unsigned>(packet.mValues[i]));
+	}
+	printf(", protocols");
+	for(size_t i = 0; i < packet.mProtocolCount; i++) {
+		printf(" %u", packet.mProtocolNumbers[i]);
+	}
+	printf("\n");
+}
+
+void RcSwitch_differential::report(const char* stream, const char* table, const DecoderEngine& engine,
+		const DifferentialResult& result) {
+	printf("%-12s %-12s %-12s %7u %6.2fx  ", stream, table, engine.name(),
+			static_cast<unsigned>(result.mPacketsCount), result.mSpeedRatio);
+	if(result.mDivergence == DIVERGENCE::NONE) {
+		printf("identical\n");
+		return;
+	}
+	printf("DIVERGENCE in %s at edge %u\n", divergenceToString(result.mDivergence),
+			static_cast<unsigned>(result.mEdgeIndex));
+	printPacket("reference", result.mbReferencePacket, result.mReferencePacket);
+	printPacket(engine.name(), result.mbEnginePacket, result.mEnginePacket);
+}
+
+size_t RcSwitch_differential::run(const char* const* recordingPaths, const size_t recordingsCount) const {
+	struct Table {
+		const char* mName;
+		RxTimingSpecTable mRxTimingSpecTable;
+	};
+	const Table tables[] = {
+		{"rcswitch", rcSwitchProtocolTable.toTimingSpecTable()},
+		{"pt2262", pt2262ProtocolTable.toTimingSpecTable()},
+	};
+
+	ReferenceEngine reference;
+	ReceiverEngine receiver;
+	MultiChannelReceiverEngine multiChannelReceiver;
+	DecoderEngine* const engines[] = {&receiver, &multiChannelReceiver};
+
+	printf("%-12s %-12s %-12s %7s %7s  %s\n", "stream", "table", "engine", "packets", "speed", "verdict");
+
+	size_t divergencesCount = 0;
+	for(const Table& table : tables) {
+		for(size_t s = 0; s < 2 + recordingsCount; s++) {
+			const char* streamName = nullptr;
+			size_t count = 0;
+			if(s == 0) {
+				/* Packets mixed with noise. */
+				RandomPulseSource pulseSource(table.mRxTimingSpecTable, 4711);
+				count = generateEdges(differentialEdges, EDGES_COUNT, pulseSource);
+				streamName = "random";
+			} else if(s == 1) {
+				/* Noise only. */
+				RandomPulseSource pulseSource(RxTimingSpecTable{nullptr, 0}, 4711);
+				count = generateEdges(differentialEdges, EDGES_COUNT, pulseSource);
+				streamName = "noise";
+			} else {
+				streamName = recordingPaths[s - 2];
+				count = loadEdges(differentialEdges, EDGES_COUNT, streamName);
+				if(count == 0) {
+					printf("Can't read a pulse trace from %s\n", streamName);
+					continue;
+				}
+			}
+			for(DecoderEngine* const engine : engines) {
+				DifferentialResult result;
+				divergencesCount += compare(reference, *engine, table.mRxTimingSpecTable,
+						differentialEdges, count, result);
+				report(streamName, table.mName, *engine, result);
+			}
+		}
+	}
+	printf("%u divergence(s)\n", static_cast<unsigned>(divergencesCount));
+	return divergencesCount;
+}
+
+} // namespace RcSwitch
+
+#endif // #if defined(ENABLE_RCSWITCH_TEST) && not defined(ARDUINO)
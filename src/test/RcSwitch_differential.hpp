@@ -0,0 +1,191 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_TEST_RCSWITCH_DIFFERENTIAL_HPP_
+#define RCSWITCH_RECEIVER_TEST_RCSWITCH_DIFFERENTIAL_HPP_
+
+/**
+ * The differential tests measure host CPU time. They are only available,
+ * when the tests are built on a host, not for an Arduino board.
+ */
+#if defined(ENABLE_RCSWITCH_TEST) && not defined(ARDUINO)
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "TestFixtures.hpp"
+#include "VirtualTime.hpp"
+#include "ReferenceReceiver.hpp"
+#include "../internal/MultiChannelReceiver.hpp"
+
+namespace RcSwitch {
+
+/**
+ * A decoding engine under differential test. Each edge is passed to
+ * handleEdge(). A packet, that has been completed by the edge, is
+ * returned and the engine continues receiving, as if resetAvailable() has
+ * been called immediately.
+ */
+class DecoderEngine {
+public:
+	virtual const char* name() const = 0;
+	/** Restart the engine with the given protocol table. */
+	virtual void begin(const RxTimingSpecTable& rxTimingSpecTable) = 0;
+	/** Returns true, if a packet has been completed. */
+	virtual bool handleEdge(const int pinLevel, const uint32_t usecEdge, MultiChannelPacket& packet) = 0;
+	virtual ~DecoderEngine() {}
+};
+
+/** The frozen reference model. */
+class ReferenceEngine : public DecoderEngine {
+	ReferenceReceiver mReceiver;
+public:
+	const char* name() const override {return "reference";}
+	void begin(const RxTimingSpecTable& rxTimingSpecTable) override;
+	bool handleEdge(const int pinLevel, const uint32_t usecEdge, MultiChannelPacket& packet) override;
+};
+
+/** Class Receiver. */
+class ReceiverEngine : public DecoderEngine {
+	Receiver* mReceiver;
+public:
+	ReceiverEngine() : mReceiver(nullptr) {}
+	~ReceiverEngine() {delete mReceiver;}
+	/** The engine owns the receiver. */
+	ReceiverEngine(const ReceiverEngine&) = delete;
+	ReceiverEngine& operator=(const ReceiverEngine&) = delete;
+	const char* name() const override {return "receiver";}
+	void begin(const RxTimingSpecTable& rxTimingSpecTable) override;
+	bool handleEdge(const int pinLevel, const uint32_t usecEdge, MultiChannelPacket& packet) override;
+};
+
+/** A single channel of class MultiChannelReceiver. */
+class MultiChannelReceiverEngine : public DecoderEngine, private MultiChannelPacketSink {
+	MultiChannelReceiver<1> mReceiver;
+	MultiChannelPacket* mPacket;
+	bool mbPacket;
+	void onPacket(const size_t channel, const MultiChannelPacket& packet) override;
+public:
+	MultiChannelReceiverEngine() : mPacket(nullptr), mbPacket(false) {}
+	const char* name() const override {return "multichannel";}
+	void begin(const RxTimingSpecTable& rxTimingSpecTable) override;
+	bool handleEdge(const int pinLevel, const uint32_t usecEdge, MultiChannelPacket& packet) override;
+};
+
+enum class DIVERGENCE : uint8_t {
+	NONE,
+	/** Only one of the engines completed a packet. */
+	PACKET,
+	BITS_COUNT,
+	VALUES,
+	/** The sets of matching protocol numbers differ. */
+	PROTOCOLS,
+};
+
+/**
+ * The outcome of feeding the same edges to the reference and to an
+ * engine. On divergence, the packets of both at the first diverging edge
+ * are kept.
+ */
+struct DifferentialResult {
+	DIVERGENCE mDivergence;
+	size_t mEdgeIndex;
+	/** Number of packets, that both completed identically before. */
+	size_t mPacketsCount;
+	bool mbReferencePacket;
+	bool mbEnginePacket;
+	MultiChannelPacket mReferencePacket;
+	MultiChannelPacket mEnginePacket;
+	/** CPU time of the reference divided by the CPU time of the engine. */
+	double mSpeedRatio;
+};
+
+/**
+ * Feeds identical random and recorded edge streams to the reference model
+ * and to decoding engines, and reports the first divergence in packets,
+ * bit counts, values or protocol sets, along with the relative speed.
+ *
+ * Usage example on a Linux host, with the library compiled with
+ * ENABLE_RCSWITCH_TEST defined. Optional arguments are recordings of
+ * example sketch TraceReceivedPulses.ino:
+ *
+ * int main(int argc, char* argv[]) {
+ *     return RcSwitch::RcSwitch_differential::theDifferential.run(
+ *         const_cast<const char**>(&argv[1]), argc - 1) ? 1 : 0;
+ * }
+ */
+class RcSwitch_differential {
+public:
+	static constexpr size_t EDGES_COUNT = 20000;
+	static constexpr size_t SPEED_REPEATS = 5;
+
+	typedef TestEdge Edge;
+
+private:
+	/** The CPU time of the cheapest of SPEED_REPEATS runs. */
+	static uint64_t nsecRun(DecoderEngine& engine, const RxTimingSpecTable& rxTimingSpecTable,
+			const Edge* edges, const size_t count);
+	static void printPacket(const char* name, const bool bPacket, const MultiChannelPacket& packet);
+
+public:
+	/** Fill the edges from a pulse source. Returns the number of edges. */
+	static size_t generateEdges(Edge* edges, const size_t capacity, PulseSource& pulseSource);
+
+	/**
+	 * Read the edges from a pulse trace, that has been printed by
+	 * RcSwitchReceiver::dumpPulseTracer() with the default separator.
+	 * Returns the number of edges.
+	 */
+	static size_t loadEdges(Edge* edges, const size_t capacity, const char* path);
+
+	/**
+	 * Feed the edges to both engines. Returns true, if the engine diverged
+	 * from the reference.
+	 */
+	static bool compare(DecoderEngine& reference, DecoderEngine& engine,
+			const RxTimingSpecTable& rxTimingSpecTable, const Edge* edges, const size_t count,
+			DifferentialResult& result);
+
+	/** Print the result of compare(). */
+	static void report(const char* stream, const char* table, const DecoderEngine& engine,
+			const DifferentialResult& result);
+
+	/**
+	 * Compare the Receiver and the MultiChannelReceiver against the
+	 * reference with random edge streams and the given recordings.
+	 * Returns the number of divergences.
+	 */
+	size_t run(const char* const* recordingPaths, const size_t recordingsCount) const;
+
+	static RcSwitch_differential theDifferential;
+};
+
+} // namespace RcSwitch
+
+#endif // #if defined(ENABLE_RCSWITCH_TEST) && not defined(ARDUINO)
+
+#endif /* RCSWITCH_RECEIVER_TEST_RCSWITCH_DIFFERENTIAL_HPP_ */
@@ -26,30 +26,33 @@
 #ifdef ENABLE_RCSWITCH_TEST
 
 #include "../RcSwitchReceiver.hpp"
+#include "../RcButtonPressDetector.hpp"
+#include "../RcSwitchPipeline.hpp"
+#include "VirtualTime.hpp"
+#include "RandomPulseSource.hpp"
+#include "TestFixtures.hpp"
+#include "ReceiverTestAccess.hpp"
+#include "../internal/MultiChannelReceiver.hpp"
+#include "../internal/TimingSpecOptimizer.hpp"
+#include "../internal/PacketStore.hpp"
+#include "ReferenceReceiver.hpp"
+#include "RcSwitch_differential.hpp"
 
 #include <limits.h>
 #include <assert.h>
 
+#if not defined(ARDUINO) && defined(__unix__)
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
 namespace RcSwitch {
 
 /** Call RcSwitch::RcSwitch_test::theTest.run() to execute tests. */
 RcSwitch_test RcSwitch_test::theTest;
 
-static const RxProtocolTable <
-	//               #, clk,  %, syA,  syB,  d0A,d0B,  d1A,d1B, inverseLevel
-	makeTimingSpec<  1, 350, 20,   1,   31,    1,  3,    3,  1, false>, // (PT2262)
-	makeTimingSpec<  2, 650, 20,   1,   10,    1,  3,    3,  1, false>, // ()
-	makeTimingSpec<  3, 100, 20,  30,   71,    4, 11,    9,  6, false>, // ()
-	makeTimingSpec<  4, 380, 20,   1,    6,    1,  3,    3,  1, false>, // ()
-	makeTimingSpec<  5, 500, 20,   6,   14,    1,  2,    2,  1, false>, // ()
-	makeTimingSpec<  6, 450, 20,   1,   23,    1,  2,    2,  1, true>, 	// (HT6P20B)
-	makeTimingSpec<  7, 150, 20,   2,   62,    1,  6,    6,  1, false>, // (HS2303-PT)
-	makeTimingSpec<  8, 200, 20,   3,  130,    7, 16,    3, 16, false>, // (Conrad RS-200)
-	makeTimingSpec<  9, 365, 20,   1,   18,    3,  1,    1,  3, true>, 	// (1ByOne Doorbell)
-	makeTimingSpec< 10, 270, 20,   1,   36,    1,  2,    2,  1, true>, 	// (HT12E)
-	makeTimingSpec< 11, 320, 20,   1,   36,    1,  2,    2,  1, true>  	// (SM5212)
-> rxProtocolTable;
-
 /** Message repeat is required for the message packet end detection */
 constexpr size_t MIN_MSG_PACKET_REPEATS = 1;
 
@@ -288,7 +291,7 @@ void RcSwitch_test::tooShortMessagePacketTest(uint32_t& usec, Receiver &receiver
 
 void RcSwitch_test::testFaultyDataRx() const {
 	Receiver receiver;
-	receiver.setRxTimingSpecTable(rxProtocolTable.toTimingSpecTable());
+	receiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
 	uint32_t usec = 0;
 
 	usec += 100; // start hi pulse 100 usec duration.
@@ -308,7 +311,7 @@ void RcSwitch_test::testFaultyDataRx() const {
 
 void RcSwitch_test::testDataRx() const {
 	Receiver receiver;
-	receiver.setRxTimingSpecTable(rxProtocolTable.toTimingSpecTable());
+	receiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
 	uint32_t usec = 0;
 
 	usec += 100; // start hi pulse 100 usec duration.
@@ -340,9 +343,1425 @@ void RcSwitch_test::testDataRx() const {
 	}
 }
 
+static void sendLongMessagePacket(uint32_t &usec, Receiver &receiver, const uint32_t head, const uint8_t tail) {
+	Protocol<1>::sendSynchPulses(usec, receiver);
+	for(size_t i = 0; i < 40; i++) {
+		const bool bit = i < 32 ? (head >> (31 - i)) & 1 : (tail >> (39 - i)) & 1;
+		const TxDataBit dataBit(bit ? DATA_BIT::LOGICAL_1 : DATA_BIT::LOGICAL_0);
+		Protocol<1>::sendDataBit(usec, receiver, &dataBit);
+	}
+}
+
+static void expectStreamItem(PacketStreamBase& packetStream, const STREAM_ITEM_TYPE type, const uint32_t value) {
+	PacketStreamItem item;
+	const bool bRead = packetStream.read(item);
+	assert(bRead);
+	assert(item.mType == type);
+	assert(item.mValue == value);
+}
+
+void RcSwitch_test::testPacketStream() const {
+	Receiver receiver;
+	PacketStream<16> packetStream;
+	receiver.setPacketStream(&packetStream);
+	receiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+	uint32_t usec = 0;
+
+	usec += 100; // start hi pulse 100 usec duration.
+	receiver.handleInterrupt(not PulseLength<1>::firstPulseEndLevel, usec);
+
+	{ // Send a 40 bit message twice, followed by the synch of a third repetition.
+		sendLongMessagePacket(usec, receiver, 0xA5C3F00F, 0x5A);
+		sendLongMessagePacket(usec, receiver, 0xA5C3F00F, 0x5A);
+		Protocol<1>::sendSynchPulses(usec, receiver);
+		assert(not receiver.available()); // Streamed packets are never available.
+
+		for(size_t i = 0; i < 2; i++) {
+			expectStreamItem(packetStream, STREAM_ITEM_TYPE::PACKET_START, 0);
+			expectStreamItem(packetStream, STREAM_ITEM_TYPE::DATA_WORD, 0xA5C3F00F);
+			expectStreamItem(packetStream, STREAM_ITEM_TYPE::DATA_WORD, 0x5A);
+			expectStreamItem(packetStream, STREAM_ITEM_TYPE::PACKET_END, 40);
+		}
+		assert(not packetStream.available());
+	}
+
+	{ // A faulty message, that breaks off before MIN_MSG_PACKET_BITS, doesn't produce any item.
+		sendMessagePacket(usec, receiver, invalidMessagePacket_firstPulseTooShort, 1);
+		assert(not packetStream.available());
+	}
+
+	{ // A faulty message, that breaks off after MIN_MSG_PACKET_BITS, must be aborted.
+		sendMessagePacket(usec, receiver, validMessagePacket_A, 1);
+		const TxDataBit tooShortDataBit(DATA_BIT::LOGICAL_0, 0.3, 1.0);
+		Protocol<1>::sendDataBit(usec, receiver, &tooShortDataBit);
+		expectStreamItem(packetStream, STREAM_ITEM_TYPE::PACKET_START, 0);
+		expectStreamItem(packetStream, STREAM_ITEM_TYPE::PACKET_ABORT, MIN_MSG_PACKET_BITS);
+		assert(not packetStream.available());
+	}
+
+	{ // A packet whose PACKET_START item didn't fit into the queue is not aborted.
+		PacketStream<4> smallStream;
+		for(size_t i = 0; i < 8; i++) {
+			smallStream.pushBit(i & 1);
+		}
+		smallStream.endPacket(1); // Fills the queue.
+		for(size_t i = 0; i < MIN_MSG_PACKET_BITS; i++) {
+			smallStream.pushBit(true);
+		}
+		smallStream.endPacket(1);
+		for(size_t i = 0; i < MIN_MSG_PACKET_BITS; i++) {
+			smallStream.pushBit(true);
+		}
+		smallStream.abortPacket();
+		assert(smallStream.overflowCount() == 1);
+		expectStreamItem(smallStream, STREAM_ITEM_TYPE::PACKET_START, 0);
+		expectStreamItem(smallStream, STREAM_ITEM_TYPE::DATA_WORD, 0x55);
+		expectStreamItem(smallStream, STREAM_ITEM_TYPE::PACKET_END, 8);
+		assert(not smallStream.available());
+	}
+}
+
+namespace {
+/** Counts printed lines. Takes a limited number of lines without blocking. */
+class LineCountingSerial {
+	const size_t mLinesCapacity;
+	size_t mLines;
+public:
+	LineCountingSerial(const size_t linesCapacity) : mLinesCapacity(linesCapacity), mLines(0) {
+	}
+	int availableForWrite() const {
+		return (mLinesCapacity - mLines) * DECODER_EVENT_MAX_LINE_LENGTH;
+	}
+	template<typename T> void print(const T&, const int = 10) {
+	}
+	template<typename T> void println(const T&) {
+		mLines++;
+	}
+	void println() {
+		mLines++;
+	}
+	size_t lines() const {
+		return mLines;
+	}
+};
+}
+
+void RcSwitch_test::testDecoderEventLog() const {
+	{ // Candidate mask with protocol indices, that don't fit into the mask.
+		ProtocolCandidates candidates;
+		candidates.setProtocolGroup(INVERSE_LEVEL_PROTOCOLS);
+		candidates.push(1);
+		candidates.push(5);
+		assert(candidates.toEventArgument() == (DECODER_EVENT_INVERSE_LEVEL_FLAG | 0x22));
+		candidates.push(6);
+		assert(candidates.toEventArgument()
+				== (DECODER_EVENT_INVERSE_LEVEL_FLAG | DECODER_EVENT_CANDIDATES_OVERFLOW_FLAG | 0x22));
+
+		candidates.reset();
+		candidates.setProtocolGroup(NORMAL_LEVEL_PROTOCOLS);
+		candidates.push(7);
+		assert(candidates.toEventArgument() == DECODER_EVENT_CANDIDATES_OVERFLOW_FLAG);
+	}
+
+	{ // dump() stops early, if the serial can't take another line.
+		DecoderEventLog<4> eventLog;
+		for(uint8_t i = 0; i < 6; i++) {
+			eventLog.log(DECODER_EVENT::BIT_APPENDED, i & 1);
+		}
+		LineCountingSerial serial(3);
+		assert(eventLog.dump(serial, 10) == 2);	// "Events lost" line + 2 events.
+		assert(serial.lines() == 3);
+		assert(eventLog.dump(serial, 10) == 0);	// Nothing printed into a full buffer.
+
+		LineCountingSerial emptySerial(10);
+		assert(eventLog.dump(emptySerial, 10) == 2);	// The remaining 2 events.
+		assert(emptySerial.lines() == 2);
+	}
+
+	{ // More lost events, than an 8 bit index can tell, don't bring back stale events.
+		DecoderEventLog<4> eventLog;
+		for(size_t i = 0; i < 300; i++) {
+			eventLog.log(DECODER_EVENT::PACKET_PUBLISHED, i);
+		}
+		assert(static_cast<uint8_t>(eventLog.mLostCount - eventLog.mReportedLostCount) == UINT8_MAX);
+		LineCountingSerial serial(10);
+		assert(eventLog.dump(serial, 10) == 4);	// "Events lost" line + the first 4 events.
+		assert(serial.lines() == 5);
+		for(uint8_t i = 0; i < 4; i++) {
+			assert(eventLog.mRecords[i].mArgument == i);
+		}
+		assert(eventLog.dump(serial, 10) == 0);
+
+		eventLog.log(DECODER_EVENT::PACKET_PUBLISHED, 4);	// Logged again after the dump.
+		LineCountingSerial emptySerial(10);
+		assert(eventLog.dump(emptySerial, 10) == 1);
+		assert(emptySerial.lines() == 1);
+	}
+
+	{ // The disabled event log takes no space as a base class.
+		struct Probe : DecoderEventLog<0> {uint32_t mValue;};
+		static_assert(sizeof(Probe) == sizeof(uint32_t),
+				"Error: The disabled event log takes space within the receiver.");
+	}
+
+#if RCSWITCH_EVENT_LOG_SIZE >= 32
+	Receiver receiver;
+	receiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+	uint32_t usec = 0;
+
+	usec += 100; // start hi pulse 100 usec duration.
+	receiver.handleInterrupt(not PulseLength<1>::firstPulseEndLevel, usec);
+
+	sendMessagePacket(usec, receiver, validMessagePacket_A, MIN_MSG_PACKET_REPEATS + 1);
+	assert(receiver.available());
+	/* Another edge while the packet is pending. */
+	usec += PulseLength<1>::synchShortPulseLength;
+	receiver.handleInterrupt(PulseLength<1>::firstPulseEndLevel, usec);
+
+	static const DecoderEventRecord expected[] = {
+		{DECODER_EVENT::SYNCH_MATCHED, 0x03},			// Match protocol #7 (index 0) and #1 (index 1)
+		{DECODER_EVENT::CANDIDATE_PRUNED, 0},			// Protocol #7 doesn't match the data pulses
+		{DECODER_EVENT::BIT_APPENDED, 0},
+		{DECODER_EVENT::BIT_APPENDED, 1},
+		{DECODER_EVENT::BIT_APPENDED, 0},
+		{DECODER_EVENT::BIT_APPENDED, 0},
+		{DECODER_EVENT::BIT_APPENDED, 1},
+		{DECODER_EVENT::BIT_APPENDED, 1},
+		{DECODER_EVENT::PACKET_PUBLISHED, 6},
+		{DECODER_EVENT::EDGE_DROPPED, 0},
+	};
+
+	const DecoderEventLog<RCSWITCH_EVENT_LOG_SIZE>& eventLog = receiver;
+	const size_t n = sizeof(expected) / sizeof(expected[0]);
+	assert(eventLog.mWriteIndex == n);
+	for(size_t i = 0; i < n; i++) {
+		assert(eventLog.mRecords[i].mEvent == expected[i].mEvent);
+		assert(eventLog.mRecords[i].mArgument == expected[i].mArgument);
+	}
+#endif
+}
+
+static const TxDataBit validMessagePacket_jitter[] = {
+		{DATA_BIT::LOGICAL_0, 1.1, 1.0 /* First pulse 10% too long */},
+		{DATA_BIT::LOGICAL_1},
+		{DATA_BIT::LOGICAL_0},
+		{DATA_BIT::LOGICAL_0, 1.0, 0.95 /* Second pulse 5% too short */},
+		{DATA_BIT::LOGICAL_1},
+		{DATA_BIT::LOGICAL_1},
+
+		// delimiter
+		{DATA_BIT::UNKNOWN},
+};
+
+void RcSwitch_test::testPacketQuality() const {
+	PacketQuality quality;
+	Receiver receiver;
+	assert(receiver.receivedPacketQuality() == nullptr);
+	receiver.setPacketQuality(&quality);
+	receiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+	uint32_t usec = 0;
+
+	usec += 100; // start hi pulse 100 usec duration.
+	receiver.handleInterrupt(not PulseLength<1>::firstPulseEndLevel, usec);
+
+	{ // Send a message with exact pulse durations.
+		sendMessagePacket(usec, receiver, validMessagePacket_A, MIN_MSG_PACKET_REPEATS + 1);
+		assert(receiver.available());
+		assert(receiver.receivedPacketQuality() == &quality);
+		assert(quality.usecMeasuredClock() == 350);
+		assert(quality.percentMaxDeviation() == 0);
+		assert(quality.percentMinMargin() == 100);
+		assert(quality.repeats() == 1);
+
+		// Further repetitions are counted while the packet is available.
+		sendMessagePacket(usec, receiver, validMessagePacket_A, 2);
+		assert(quality.repeats() == 3);
+	}
+
+	{ // Send a message with pulse jitter.
+		receiver.reset();
+		sendMessagePacket(usec, receiver, validMessagePacket_jitter, MIN_MSG_PACKET_REPEATS + 1);
+		assert(receiver.available());
+		assert(receiver.receivedValue() == 0x13 /* binary: 010011 */);
+		/* 12 pulses, nominal 8400usec, measured 8400 + 35 - 52 usec */
+		assert(quality.usecMeasuredClock() == 349);
+		assert(quality.percentMaxDeviation() == 10);
+		/* The 10% too long pulse is 35usec away from the upper bound of [280..420[. */
+		assert(quality.percentMinMargin() == 50);
+	}
+}
+
+void RcSwitch_test::testSharedPulseTracer() const {
+	SharedPulseTracer<8> sharedPulseTracer;
+	ReceiverWithSharedPulseTracer receiver_0;
+	ReceiverWithSharedPulseTracer receiver_2;
+	receiver_0.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+	receiver_2.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+	assert(receiver_0.attachPulseTracer(&sharedPulseTracer, 0));
+	assert(receiver_2.attachPulseTracer(&sharedPulseTracer, 2));
+	{ // Out of range source ids would alias the ids of other receivers.
+		ReceiverWithSharedPulseTracer receiver_4;
+		assert(not receiver_4.attachPulseTracer(&sharedPulseTracer, MAX_TRACE_SOURCE_ID + 1));
+		assert(receiver_4.mSharedPulseTracer == nullptr);
+	}
+
+	// Interleave the pulses of both receivers.
+	receiver_0.handleInterrupt(1, 100);	// lo pulse 100 usec
+	receiver_2.handleInterrupt(0, 200);	// hi pulse 200 usec
+	receiver_0.handleInterrupt(0, 400);	// hi pulse 300 usec
+	receiver_2.handleInterrupt(1, 700);	// lo pulse 500 usec
+	receiver_0.handleInterrupt(1, 1000);	// lo pulse 600 usec
+
+	const TraceRecordReadAccess all = sharedPulseTracer.readAccess();
+	assert(all.size() == 5);
+
+	const TraceRecordReadAccess source_0 = sharedPulseTracer.readAccess(0);
+	assert(source_0.size() == 3);
+	assert(receiver_0.tracedPulsesCount() == 3);
+	assert(source_0.at(0).getPulse().getDuration() == 100);
+	assert(source_0.at(0).getPulse().getLevel() == PULSE_LEVEL::LO);
+	assert(source_0.at(2).getPulse().getDuration() == 600);
+	// Access backwards.
+	assert(source_0.at(1).getPulse().getDuration() == 300);
+	assert(source_0.at(1).getPulse().getLevel() == PULSE_LEVEL::HI);
+
+	const TraceRecordReadAccess source_2 = sharedPulseTracer.readAccess(2);
+	assert(source_2.size() == 2);
+	assert(receiver_2.tracedPulsesCount() == 2);
+	assert(source_2.at(0).getPulse().getDuration() == 200);
+	assert(source_2.at(1).getPulse().getDuration() == 500);
+
+	const TraceRecordReadAccess source_1 = sharedPulseTracer.readAccess(1);
+	assert(source_1.size() == 0);
+
+	// Overwrite the oldest trace records.
+	for(uint32_t usec = 1100; usec < 1600; usec += 100) {
+		receiver_2.handleInterrupt(usec % 200 ? 0 : 1, usec);
+	}
+	const TraceRecordReadAccess wrapped = sharedPulseTracer.readAccess();
+	assert(wrapped.size() == 8);
+	assert(wrapped.at(0).getPulse().getDuration() == 300);
+	assert(wrapped.at(7).getPulse().getDuration() == 100);
+	assert(sharedPulseTracer.readAccess(0).size() == 2);
+	assert(sharedPulseTracer.readAccess(0).at(1).getPulse().getDuration() == 600);
+	assert(receiver_2.tracedPulsesCount() == 6);
+}
+
+class TestButtonPressDetector : public RcButtonPressDetector, public VirtualTimeScheduler::LoopTask {
+	static constexpr size_t MAX_RECORDED_PRESSES = 8;
+public:
+	mutable size_t mPressedCount = 0;
+	mutable rcButtonCode_t mPressed[MAX_RECORDED_PRESSES] = {};
+
+	TestButtonPressDetector(Receiver& receiver) {
+		mRcSwitchReceiver = &receiver;
+	}
+
+	rcButtonCode_t rcDataToButton(const int rcProtocol, const receivedValue_t receivedData) const override {
+		switch(receivedData) {
+			case 0x13: return 'A';
+			case 0x2C: return 'B';
+		}
+		return RcButtonPressDetector::rcDataToButton(rcProtocol, receivedData);
+	}
+
+	void onButtonPressed(rcButtonCode_t buttonCode) const override {
+		if(mPressedCount < MAX_RECORDED_PRESSES) {
+			mPressed[mPressedCount] = buttonCode;
+		}
+		++mPressedCount;
+	}
+
+	void loop() override {
+		scanRcButtons();
+	}
+};
+
+void RcSwitch_test::testButtonPressDebounce() const {
+	Receiver receiver;
+	receiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+	TestButtonPressDetector buttonPressDetector(receiver); // 250 msec debounce delay time
+
+	static const ButtonTrafficSource::ButtonPress buttonPresses[] = {
+		{0x13, 6, 4,  100000},	// A, released for 100 msec
+		{0x13, 6, 4, 1000000},	// A again within debounce delay time, released for 1 sec
+		{0x2C, 6, 4,  100000},	// B, released for 100 msec
+		{0x13, 6, 4, 1000000},	// A within debounce delay time, but a different button
+	};
+	constexpr size_t buttonPressesCount = sizeof(buttonPresses) / sizeof(buttonPresses[0]);
+
+	// About 85 minutes of traffic, so that micros() wraps around.
+	constexpr size_t cyclesCount = 2000;
+	ButtonTrafficSource buttonTraffic(350, 1, 31, 1, 3, 3, 1, false,
+			buttonPresses, buttonPressesCount, cyclesCount);
+
+	VirtualClock::start();
+	VirtualTimeScheduler scheduler(receiver, buttonTraffic, buttonPressDetector, 1000 /* loop every msec */);
+
+	scheduler.runFor(2500000);
+	assert(buttonPressDetector.mPressedCount == 3);
+	assert(buttonPressDetector.mPressed[0] == 'A');
+	assert(buttonPressDetector.mPressed[1] == 'B');
+	assert(buttonPressDetector.mPressed[2] == 'A');
+
+	scheduler.runFor(5400000000ULL);
+	assert(buttonPressDetector.mPressedCount == 3 * cyclesCount);
+	assert(VirtualClock::now() > UINT32_MAX);
+	VirtualClock::stop();
+}
+
+/**
+ * Compares the packets of a MultiChannelReceiver channel with the
+ * packets of a Receiver, that receives the same pulses.
+ */
+template<size_t CHANNELS_COUNT>
+class ComparingPacketSink : public MultiChannelPacketSink {
+public:
+	MultiChannelPacket mExpected[CHANNELS_COUNT];
+	bool mPending[CHANNELS_COUNT] = {};
+	size_t mPacketsCount = 0;
+
+	void expect(const size_t channel, const Receiver& receiver) {
+		MultiChannelPacket& expected = mExpected[channel];
+		expected.mValuesCount = receiver.receivedValuesCount();
+		for(size_t i = 0; i < expected.mValuesCount; i++) {
+			expected.mValues[i] = receiver.receivedValueAt(i);
+		}
+		expected.mBitsCount = receiver.receivedBitsCount();
+		expected.mProtocolCount = receiver.receivedProtocolCount();
+		for(size_t i = 0; i < expected.mProtocolCount; i++) {
+			expected.mProtocolNumbers[i] = receiver.receivedProtocol(i);
+		}
+		mPending[channel] = true;
+	}
+
+	void onPacket(const size_t channel, const MultiChannelPacket& packet) override {
+		const MultiChannelPacket& expected = mExpected[channel];
+		assert(mPending[channel]);
+		assert(packet.mValuesCount == expected.mValuesCount);
+		for(size_t i = 0; i < expected.mValuesCount; i++) {
+			assert(packet.mValues[i] == expected.mValues[i]);
+		}
+		assert(packet.mBitsCount == expected.mBitsCount);
+		assert(packet.mProtocolCount == expected.mProtocolCount);
+		for(size_t i = 0; i < expected.mProtocolCount; i++) {
+			assert(packet.mProtocolNumbers[i] == expected.mProtocolNumbers[i]);
+		}
+		mPending[channel] = false;
+		++mPacketsCount;
+	}
+};
+
+/**
+ * Feed the pulses of each source into a receiver and into the corresponding
+ * channel of the multi channel receiver. Both must deliver the same packets.
+ * Returns the number of compared packets.
+ */
+template<size_t CHANNELS_COUNT>
+size_t compareMultiChannelReceiver(MultiChannelReceiver<CHANNELS_COUNT>& multiChannelReceiver,
+		Receiver* const receivers, RandomPulseSource* const* const pulseSources, const size_t edgesPerChannel) {
+	ComparingPacketSink<CHANNELS_COUNT> packetSink;
+	multiChannelReceiver.setPacketSink(&packetSink);
+
+	uint32_t usecEdges[CHANNELS_COUNT] = {};
+	uint8_t pinLevels[CHANNELS_COUNT];
+	for(size_t n = 0; n < edgesPerChannel; n++) {
+		for(size_t c = 0; c < CHANNELS_COUNT; c++) {
+			uint32_t usecDuration = 0;
+			int pinLevel = 0;
+			pulseSources[c]->nextPulse(usecDuration, pinLevel);
+			usecEdges[c] += usecDuration;
+			pinLevels[c] = pinLevel;
+
+			Receiver& receiver = receivers[c];
+			RcSwitch_test::handleInterrupt(receiver, pinLevel, usecEdges[c]);
+			if(receiver.available()) {
+				packetSink.expect(c, receiver);
+				receiver.resetAvailable();
+			}
+		}
+
+		// Advance the first half of the channels in lockstep, the other half one by one.
+		multiChannelReceiver.handleEdges(0, CHANNELS_COUNT / 2, usecEdges, pinLevels);
+		for(size_t c = CHANNELS_COUNT / 2; c < CHANNELS_COUNT; c++) {
+			multiChannelReceiver.handleEdge(c, pinLevels[c], usecEdges[c]);
+		}
+
+		for(size_t c = 0; c < CHANNELS_COUNT; c++) {
+			assert(not packetSink.mPending[c]);
+		}
+	}
+	multiChannelReceiver.setPacketSink(nullptr);
+	return packetSink.mPacketsCount;
+}
+
+void RcSwitch_test::testMultiChannelReceiver() const {
+	{ // A board sized run.
+		MultiChannelReceiver<2> multiChannelReceiver;
+		multiChannelReceiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+		Receiver receivers[2];
+		receivers[0].setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+		receivers[1].setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+		RandomPulseSource pulseSource_0(rcSwitchProtocolTable.toTimingSpecTable(), 4711);
+		RandomPulseSource pulseSource_1(rcSwitchProtocolTable.toTimingSpecTable(), 4712);
+		RandomPulseSource* const pulseSources[] = {&pulseSource_0, &pulseSource_1};
+		assert(compareMultiChannelReceiver(multiChannelReceiver, receivers, pulseSources, 2000) > 5);
+	}
+
+#if not defined(ARDUINO)
+	{ // A long run with many channels on the host.
+		constexpr size_t CHANNELS_COUNT = 8;
+		static MultiChannelReceiver<CHANNELS_COUNT> multiChannelReceiver;
+		multiChannelReceiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+		Receiver receivers[CHANNELS_COUNT];
+		RandomPulseSource* pulseSources[CHANNELS_COUNT];
+		for(size_t c = 0; c < CHANNELS_COUNT; c++) {
+			receivers[c].setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+			pulseSources[c] = new RandomPulseSource(rcSwitchProtocolTable.toTimingSpecTable(), 4711 + c);
+		}
+		assert(compareMultiChannelReceiver(multiChannelReceiver, receivers, pulseSources, 20000) > 100);
+		for(size_t c = 0; c < CHANNELS_COUNT; c++) {
+			delete pulseSources[c];
+		}
+	}
+#endif
+}
+
+void RcSwitch_test::testTimingTuner() const {
+	TimingTuner<decltype(rcSwitchProtocolTable)::ROW_COUNT> timingTuner(rcSwitchProtocolTable.toTimingSpecTable());
+	Receiver receiver;
+	receiver.setTimingTuner(&timingTuner);
+	receiver.setRxTimingSpecTable(timingTuner.toTimingSpecTable());
+	uint32_t usec = 0;
+
+	const Pulse synchPulseA(290u, PULSE_LEVEL::HI);	// Within protocol #1 and #7
+	const Pulse synchPulseB(10850u, PULSE_LEVEL::LO);
+	receiver.collectProtocolCandidates(synchPulseA, synchPulseB);
+	assert(receiver.mProtocolCandidates.size() == 2);
+	receiver.reset();
+
+	usec += 100; // start hi pulse 100 usec duration.
+	receiver.handleInterrupt(not PulseLength<1>::firstPulseEndLevel, usec);
+
+	// Protocol #7 is dropped on the first data bit. So packets are unambiguous.
+	for(size_t i = 0; i < 3; i++) {
+		sendMessagePacket(usec, receiver, validMessagePacket_A, MIN_MSG_PACKET_REPEATS + 1);
+		assert(receiver.available());
+		assert(receiver.receivedProtocolCount() == 1);
+		// No tuning while a received packet is available.
+		assert(not receiver.tuneTimingSpec());
+		receiver.resetAvailable();
+	}
+	assert(receiver.tuneTimingSpec());
+
+	const RxTimingSpecTable tunedTable = timingTuner.toTimingSpecTable();
+	const RxTimingSpecTable originalTable = rcSwitchProtocolTable.toTimingSpecTable();
+	for(size_t i = 0; i < tunedTable.size; i++) {
+		const RxTimingSpec& tuned = tunedTable.start[i];
+		const RxTimingSpec& original = originalTable.start[i];
+		if(tuned.protocolNumber == 1) {
+			assert(timingTuner.observedTiming(i).mPacketsCount == 3);
+			/* 350 usec +/- 10% guard. The lower bound is clamped to the one
+			 * of protocol #4, that follows within the table. */
+			assert(tuned.synchronizationPulsePair.durationA.lowerBound == 304);
+			assert(tuned.synchronizationPulsePair.durationA.upperBound == 386);
+			assert(tuned.synchronizationPulsePair.durationB.lowerBound == 10850 - 1085);
+			assert(tuned.synchronizationPulsePair.durationB.upperBound == 10850 + 1085 + 1);
+			assert(tuned.data0pulsePair.durationA.lowerBound == 315);
+			assert(tuned.data0pulsePair.durationB.lowerBound == 1050 - 105);
+			assert(tuned.data1pulsePair.durationA.upperBound == 1050 + 105 + 1);
+		} else {
+			assert(timingTuner.observedTiming(i).mPacketsCount == 0);
+			assert(tuned.synchronizationPulsePair.durationA.lowerBound == original.synchronizationPulsePair.durationA.lowerBound);
+			assert(tuned.data0pulsePair.durationB.upperBound == original.data0pulsePair.durationB.upperBound);
+		}
+		if(i > 0 && tuned.bInverseLevel == tunedTable.start[i-1].bInverseLevel) {
+			assert(tunedTable.start[i-1].synchronizationPulsePair.durationA.lowerBound <=
+					tuned.synchronizationPulsePair.durationA.lowerBound);
+		}
+	}
+
+	// The 290 usec synch pulse does not match protocol #1 any longer.
+	receiver.collectProtocolCandidates(synchPulseA, synchPulseB);
+	assert(receiver.mProtocolCandidates.size() == 1);
+	receiver.reset();
+
+	// Packets are still received with the tuned table.
+	sendMessagePacket(usec, receiver, validMessagePacket_B, MIN_MSG_PACKET_REPEATS + 1);
+	assert(receiver.available());
+	assert(receiver.receivedValue() == 0x2C);
+
+	timingTuner.clear();
+	assert(timingTuner.toTimingSpecTable().start[0].synchronizationPulsePair.durationA.lowerBound ==
+			originalTable.start[0].synchronizationPulsePair.durationA.lowerBound);
+
+	{ // Tuning keeps the streamed packets, that haven't been read yet.
+		PacketStream<16> packetStream;
+		Receiver streamReceiver;
+		streamReceiver.setTimingTuner(&timingTuner);
+		streamReceiver.setPacketStream(&packetStream);
+		streamReceiver.setRxTimingSpecTable(timingTuner.toTimingSpecTable());
+		usec += 100;
+		streamReceiver.handleInterrupt(not PulseLength<1>::firstPulseEndLevel, usec);
+
+		sendLongMessagePacket(usec, streamReceiver, 0xA5C3F00F, 0x5A);
+		Protocol<1>::sendSynchPulses(usec, streamReceiver);
+		assert(streamReceiver.tuneTimingSpec());
+		assert(not streamReceiver.mSuspended);
+
+		// Decoding continues after tuning.
+		sendLongMessagePacket(usec, streamReceiver, 0xA5C3F00F, 0x5A);
+		Protocol<1>::sendSynchPulses(usec, streamReceiver);
+		for(size_t i = 0; i < 2; i++) {
+			expectStreamItem(packetStream, STREAM_ITEM_TYPE::PACKET_START, 0);
+			expectStreamItem(packetStream, STREAM_ITEM_TYPE::DATA_WORD, 0xA5C3F00F);
+			expectStreamItem(packetStream, STREAM_ITEM_TYPE::DATA_WORD, 0x5A);
+			expectStreamItem(packetStream, STREAM_ITEM_TYPE::PACKET_END, 40);
+		}
+		assert(not packetStream.available());
+	}
+}
+
+void RcSwitch_test::testTimingSpecOptimizer() const {
+	const RxTimingSpecTable deployedTable = rcSwitchProtocolTable.toTimingSpecTable();
+	TimingSpecOptimizer optimizer(deployedTable);
+
+	// A transmitter with a clock of about 470 usec.
+	const duration_t observation[TIMING_WINDOWS_COUNT][2] = {
+		{460, 480}, {9700, 9900}, {460, 480}, {1380, 1420}, {1380, 1420}, {460, 480},
+	};
+	TimingSpecProposal proposal;
+	ObservedTiming observed;
+	observed.clear();
+	assert(not optimizer.optimize(observed, false, proposal));
+	for(size_t w = 0; w < TIMING_WINDOWS_COUNT; w++) {
+		observed.mRanges[w].add(observation[w][0]);
+		observed.mRanges[w].add(observation[w][1]);
+	}
+
+	// The fixed 10 usec clock proposal shares the synch ranges with protocol #1.
+	size_t overlappingProtocolsCount = 0;
+	const RxTimingSpec fixedClockProposal = makeTimingSpec<12, 10, 20, 47, 980, 47, 141, 141, 47, false>::RX;
+	assert(optimizer.usecOverlap(fixedClockProposal, overlappingProtocolsCount) > 0);
+	assert(overlappingProtocolsCount == 1);
+
+	assert(optimizer.optimize(observed, false, proposal));
+	assert(proposal.usecOverlap == 0);
+	assert(proposal.overlappingProtocolsCount == 0);
+	assert(proposal.multiples[SYNCH_A_WINDOW] == 1);
+	assert(proposal.multiples[DATA0_B_WINDOW] == 3 * proposal.multiples[DATA0_A_WINDOW]);
+
+	const RxTimingSpec timingSpec = proposal.toRxTimingSpec(12);
+	assert(optimizer.usecOverlap(timingSpec, overlappingProtocolsCount) == 0);
+	// The synch A range starts above the one of protocol #1.
+	assert(timingSpec.synchronizationPulsePair.durationA.lowerBound >=
+			deployedTable.start[1].synchronizationPulsePair.durationA.upperBound);
+	for(size_t w = 0; w < TIMING_WINDOWS_COUNT; w++) {
+		const TimeRange& timeRange = timeRangeOf(timingSpec, static_cast<TIMING_WINDOW>(w));
+		assert(timeRange.compare(observation[w][0]) == TimeRange::IS_WITHIN);
+		assert(timeRange.compare(observation[w][1]) == TimeRange::IS_WITHIN);
+	}
+
+	// An observation of protocol #1 can't be separated from protocol #1.
+	const duration_t protocol1[TIMING_WINDOWS_COUNT] = {350, 10850, 350, 1050, 1050, 350};
+	observed.clear();
+	for(size_t w = 0; w < TIMING_WINDOWS_COUNT; w++) {
+		observed.mRanges[w].add(protocol1[w]);
+	}
+	assert(optimizer.optimize(observed, false, proposal));
+	assert(proposal.overlappingProtocolsCount >= 1);
+	assert(proposal.multiples[SYNCH_A_WINDOW] == 1);
+	assert(proposal.multiples[SYNCH_B_WINDOW] == 31);
+}
+
+void RcSwitch_test::testBandMonitor() const {
+	VirtualClock::start();
+	BandMonitor bandMonitor(20000);
+	Receiver receiver;
+	receiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+	receiver.setBandMonitor(&bandMonitor);
+	uint32_t usec = 0;
+
+	// 20 pulses of 100 usec, alternating lo and hi.
+	for(size_t i = 0; i < 20; i++) {
+		usec += 100;
+		receiver.handleInterrupt(i & 1, usec);
+	}
+	// A quiet band of 30000 usec, while the receiver is suspended.
+	receiver.suspend();
+	usec += 30000;
+	receiver.handleInterrupt(0, usec);
+	usec += 40000;
+	receiver.handleInterrupt(1, usec);
+	VirtualClock::advanceTo(usec);
+
+	BandSnapshot snapshot;
+	bandMonitor.snapshot(snapshot);
+	assert(snapshot.mEdgesCount == 22);
+	assert(snapshot.mUsecInterval == 72000);
+	// 100 usec pulses are within bin [64 .. 128[
+	assert(BandSnapshot::usecBinLowerBound(7) == 64);
+	assert(snapshot.mBins[BAND_LO_PULSES][7] == 10);
+	assert(snapshot.mBins[BAND_HI_PULSES][7] == 10);
+	// The 30000 usec pulse ended with pin level 0, so it was a hi pulse.
+	assert(snapshot.mBins[BAND_HI_PULSES][15] == 1);
+	// All longer pulses are in the last bin.
+	assert(snapshot.mBins[BAND_LO_PULSES][BAND_HISTOGRAM_BINS - 1] == 1);
+	// Each 100 usec pulse is estimated at the bin middle of 96 usec.
+	assert(snapshot.mUsecActive == 1920);
+	assert(snapshot.percentActivity() == 2);
+	assert(snapshot.edgesPerSecond() == 305);
+	assert(snapshot.mPeakEdgesPerSecond == 305);
+
+	// The next interval starts from scratch, the peak rate is kept.
+	const uint32_t durations[] = {0, 1, 2, 255, 256, 32767, 32768};
+	const size_t bins[] = {0, 1, 2, 8, 9, 15, 16};
+	for(size_t i = 0; i < sizeof(durations) / sizeof(durations[0]); i++) {
+		usec += durations[i];
+		receiver.handleInterrupt(1, usec);
+	}
+	VirtualClock::advanceTo(usec + 1000000);
+	bandMonitor.snapshot(snapshot);
+	assert(snapshot.mEdgesCount == 7);
+	for(size_t i = 0; i < sizeof(bins) / sizeof(bins[0]); i++) {
+		assert(snapshot.mBins[BAND_LO_PULSES][bins[i]] == 1);
+	}
+	assert(snapshot.mBins[BAND_LO_PULSES][7] == 0);
+	assert(snapshot.edgesPerSecond() < 305);
+	assert(snapshot.mPeakEdgesPerSecond == 305);
+
+	bandMonitor.reset();
+	bandMonitor.snapshot(snapshot);
+	assert(snapshot.mEdgesCount == 0);
+	assert(snapshot.mPeakEdgesPerSecond == 0);
+	receiver.resume();
+	VirtualClock::stop();
+}
+
+#if not defined(ARDUINO) && defined(__unix__)
+class PacketCounter : public PacketRecordVisitor {
+public:
+	size_t mCount = 0;
+	uint64_t mUsecLast = 0;
+	bool visit(const PacketRecord& record) override {
+		assert(record.mUsecTimestamp >= mUsecLast);
+		mUsecLast = record.mUsecTimestamp;
+		++mCount;
+		return true;
+	}
+};
+#endif
+
+void RcSwitch_test::testPacketStore() const {
+#if not defined(ARDUINO) && defined(__unix__)
+	char directory[] = "/tmp/rcswitch_test_XXXXXX";
+	const char* const createdDirectory = mkdtemp(directory);
+	assert(createdDirectory);
+
+	// 2 full segments and a partial third one.
+	static constexpr size_t RECORDS_COUNT = 2 * PacketStore::SEGMENT_RECORDS + 1000;
+	{
+		PacketStore packetStore(directory);
+		const bool bOpened = packetStore.open();
+		assert(bOpened);
+		PacketRecord record = {};
+		size_t appendedCount = 0;
+		for(size_t i = 0; i < RECORDS_COUNT; i++) {
+			record.mUsecTimestamp = 1000 * i;
+			record.mProtocolNumber = 1 + i % 3;
+			record.mValues[0] = i % 1000;
+			record.mValuesCount = 1;
+			record.mBitsCount = 24;
+			if(packetStore.append(record)) {
+				++appendedCount;
+			}
+		}
+		assert(appendedCount == RECORDS_COUNT);
+		assert(packetStore.segmentsCount() == 3);
+		assert(packetStore.recordsCount() == RECORDS_COUNT);
+
+		// A time range of 1000 records touches 8 or 9 pages.
+		PacketCounter counter;
+		const size_t rangeCount = packetStore.query(PacketQuery::timeRange(1000000, 1999000), counter);
+		assert(rangeCount == 1000);
+		assert(counter.mCount == 1000);
+		assert(packetStore.scannedPagesCount() <= 9);
+
+		// Protocol 2 and value 1 are at i = 1, 3001, 6001, ...
+		const size_t scannedPagesCount = packetStore.scannedPagesCount();
+		PacketCounter pointCounter;
+		const size_t n = packetStore.query(PacketQuery::point(2, 1, 0, UINT64_MAX), pointCounter);
+		assert(n == (RECORDS_COUNT - 1 + 2999) / 3000);
+		// The bloom filters skip most of the 513 pages.
+		assert(packetStore.scannedPagesCount() - scannedPagesCount < 100);
+
+		// Stopping the query.
+		class FirstOnly : public PacketRecordVisitor {
+			bool visit(const PacketRecord&) override {return false;}
+		} firstOnly;
+		const size_t firstOnlyCount = packetStore.query(PacketQuery::timeRange(0, UINT64_MAX), firstOnly);
+		assert(firstOnlyCount == 1);
+	}
+
+	// A file of a different size is not taken as a segment and stays untouched.
+	// It is behind a gap at index 3.
+	char path[sizeof(directory) + 32];
+	snprintf(path, sizeof(path), "%s/segment-%06u.rcs", directory, 4u);
+	FILE* const foreignFile = fopen(path, "w");
+	assert(foreignFile);
+	const size_t writtenCount = fwrite("not a segment", 1, 13, foreignFile);
+	fclose(foreignFile);
+	assert(writtenCount == 13);
+
+	// The records persist after reopening.
+	{
+		PacketStore packetStore(directory);
+		const bool bOpened = packetStore.open();
+		assert(bOpened);
+		assert(packetStore.segmentsCount() == 3);
+		assert(packetStore.recordsCount() == RECORDS_COUNT);
+		PacketCounter counter;
+		const size_t pointCount = packetStore.query(PacketQuery::point(1, 0, 0, UINT64_MAX), counter);
+		assert(pointCount == (RECORDS_COUNT + 2999) / 3000);
+
+		// Append from a receiver.
+		Receiver receiver;
+		receiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+		const bool bAppended = packetStore.append(0, 0, receiver);
+		assert(not bAppended);
+
+		MultiChannelPacket packet = {};
+		packet.mValues[0] = 0x13;
+		packet.mValuesCount = 1;
+		packet.mBitsCount = 24;
+		packet.mProtocolNumbers[0] = 7;
+		packet.mProtocolCount = 1;
+		PacketStoreSink packetSink(packetStore);
+		packetSink.onPacket(5, packet);
+		PacketCounter sinkCounter;
+		const size_t sinkCount = packetStore.query(PacketQuery::point(7, 0x13, 0, UINT64_MAX), sinkCounter);
+		assert(sinkCount == 1);
+
+		// Fill the third segment. The next segment is created behind the foreign file.
+		PacketRecord record = {};
+		const size_t fillCount = PacketStore::SEGMENT_RECORDS - 1000;
+		size_t appendedCount = 0;
+		for(size_t i = 0; i < fillCount; i++) {
+			record.mUsecTimestamp = 1000 * (RECORDS_COUNT + i);
+			if(packetStore.append(record)) {
+				++appendedCount;
+			}
+		}
+		assert(appendedCount == fillCount);
+		assert(packetStore.segmentsCount() == 4);
+		packetStore.close();
+	}
+
+	struct stat foreignStat;
+	const int statResult = stat(path, &foreignStat);
+	assert(statResult == 0);
+	assert(foreignStat.st_size == 13);
+
+	struct stat segmentStat;
+	snprintf(path, sizeof(path), "%s/segment-%06u.rcs", directory, 5u);
+	const int segmentStatResult = stat(path, &segmentStat);
+	assert(segmentStatResult == 0);
+	assert(segmentStat.st_size == static_cast<off_t>(PacketStore::SEGMENT_FILE_SIZE));
+
+	const unsigned segmentIndices[] = {0, 1, 2, 4, 5};
+	for(const unsigned i : segmentIndices) {
+		snprintf(path, sizeof(path), "%s/segment-%06u.rcs", directory, i);
+		const int unlinkResult = unlink(path);
+		assert(unlinkResult == 0);
+	}
+	const int rmdirResult = rmdir(directory);
+	assert(rmdirResult == 0);
+#endif
+}
+
+#if not defined(ARDUINO)
+/** An engine with a deliberate fault: Packet values of protocol 1 have bit 0 flipped. */
+class FaultyEngine : public ReferenceEngine {
+public:
+	const char* name() const override {return "faulty";}
+	bool handleEdge(const int pinLevel, const uint32_t usecEdge, MultiChannelPacket& packet) override {
+		const bool bPacket = ReferenceEngine::handleEdge(pinLevel, usecEdge, packet);
+		if(bPacket && packet.mProtocolNumbers[0] == 1) {
+			packet.mValues[0] ^= 1;
+		}
+		return bPacket;
+	}
+};
+#endif
+
+void RcSwitch_test::testReferenceReceiver() const {
+	const RxTimingSpecTable rxTimingSpecTable = rcSwitchProtocolTable.toTimingSpecTable();
+	ReferenceReceiver referenceReceiver;
+	referenceReceiver.setRxTimingSpecTable(rxTimingSpecTable);
+	Receiver receiver;
+	receiver.setRxTimingSpecTable(rxTimingSpecTable);
+	RandomPulseSource pulseSource(rxTimingSpecTable, 4711);
+
+	uint32_t usec = 0;
+	size_t packetsCount = 0;
+	for(size_t i = 0; i < 5000; i++) {
+		uint32_t usecDuration = 0;
+		int pinLevel = 0;
+		pulseSource.nextPulse(usecDuration, pinLevel);
+		usec += usecDuration;
+		referenceReceiver.handleInterrupt(pinLevel, usec);
+		receiver.handleInterrupt(pinLevel, usec);
+		assert(referenceReceiver.available() == receiver.available());
+		if(receiver.available()) {
+			++packetsCount;
+			assert(referenceReceiver.receivedBitsCount() == receiver.receivedBitsCount());
+			assert(referenceReceiver.receivedValueAt(0) == receiver.receivedValueAt(0));
+			assert(referenceReceiver.receivedProtocolCount() == receiver.receivedProtocolCount());
+			for(size_t p = 0; p < receiver.receivedProtocolCount(); p++) {
+				assert(referenceReceiver.receivedProtocol(p) == receiver.receivedProtocol(p));
+			}
+			referenceReceiver.resetAvailable();
+			receiver.resetAvailable();
+		}
+	}
+	assert(packetsCount > 10);
+
+#if not defined(ARDUINO)
+	/* The harness finds the first packet of protocol 1. */
+	static RcSwitch_differential::Edge edges[5000];
+	RandomPulseSource harnessPulseSource(rxTimingSpecTable, 4711);
+	const size_t count = RcSwitch_differential::generateEdges(edges, 5000, harnessPulseSource);
+	assert(count == 5000);
+
+	ReferenceEngine reference;
+	ReceiverEngine receiverEngine;
+	MultiChannelReceiverEngine multiChannelReceiverEngine;
+	DifferentialResult result;
+	assert(not RcSwitch_differential::compare(reference, receiverEngine, rxTimingSpecTable, edges, count, result));
+	assert(result.mPacketsCount == packetsCount);
+	assert(result.mSpeedRatio > 0);
+	assert(not RcSwitch_differential::compare(reference, multiChannelReceiverEngine, rxTimingSpecTable, edges, count, result));
+	assert(result.mPacketsCount == packetsCount);
+
+	FaultyEngine faultyEngine;
+	assert(RcSwitch_differential::compare(reference, faultyEngine, rxTimingSpecTable, edges, count, result));
+	assert(result.mDivergence == DIVERGENCE::VALUES);
+	assert(result.mbReferencePacket && result.mbEnginePacket);
+	assert(result.mReferencePacket.mValues[0] == (result.mEnginePacket.mValues[0] ^ 1));
+	assert(result.mEdgeIndex < count);
+#endif
+}
+
+struct TestPipelineButtons {
+	static int map(const unsigned int, const receivedValue_t value) {
+		switch(value) {
+			case 0x13: return 'A';
+			case 0x2C: return 'B';
+		}
+		return NO_BUTTON;
+	}
+};
+
+struct TestPipelineHandler {
+	static constexpr size_t MAX_RECORDED_BUTTONS = 8;
+	static size_t mPacketsCount;
+	static size_t mButtonsCount;
+	static int mButtons[MAX_RECORDED_BUTTONS];
+
+	static void reset() {
+		mPacketsCount = 0;
+		mButtonsCount = 0;
+	}
+
+	static void onPacket(const PipelinePacket& packet) {
+		assert(packet.value() == 0x13 || packet.value() == 0x2C);
+		assert(packet.mBitsCount == 6);
+		++mPacketsCount;
+	}
+
+	static void onButton(const int buttonCode, const PipelinePacket&) {
+		if(mButtonsCount < MAX_RECORDED_BUTTONS) {
+			mButtons[mButtonsCount] = buttonCode;
+		}
+		++mButtonsCount;
+	}
+};
+
+/** Records the edges, that the previous pipeline stage passes on. */
+struct TestEdgeRecorder {
+	static constexpr size_t MAX_RECORDED_EDGES = 4;
+	TestEdge mEdges[MAX_RECORDED_EDGES];
+	size_t mEdgesCount = 0;
+
+	void begin(const RxTimingSpecTable&) {mEdgesCount = 0;}
+	void onEdge(const int pinLevel, const uint32_t usecEdge) {
+		if(mEdgesCount < MAX_RECORDED_EDGES) {
+			mEdges[mEdgesCount++] = TestEdge{usecEdge, static_cast<uint8_t>(pinLevel)};
+		}
+	}
+	void flush() {}
+};
+
+size_t TestPipelineHandler::mPacketsCount = 0;
+size_t TestPipelineHandler::mButtonsCount = 0;
+int TestPipelineHandler::mButtons[MAX_RECORDED_BUTTONS] = {};
+
+void RcSwitch_test::testPipeline() const {
+	static const ButtonTrafficSource::ButtonPress buttonPresses[] = {
+		{0x13, 6, 4,  100000},	// A, released for 100 msec
+		{0x13, 6, 4, 1000000},	// A again within release time, released for 1 sec
+		{0x2C, 6, 4,  100000},	// B, released for 100 msec
+		{0x13, 6, 4, 1000000},	// A within release time, but a different button
+	};
+	constexpr size_t buttonPressesCount = sizeof(buttonPresses) / sizeof(buttonPresses[0]);
+	ButtonTrafficSource buttonTraffic(350, 1, 31, 1, 3, 3, 1, false,
+			buttonPresses, buttonPressesCount, 1);
+
+	// Record the edges and put a 20 usec glitch into each long pulse.
+	static TestEdge edges[1000];
+	size_t edgesCount = 0;
+	size_t glitchesCount = 0;
+	uint32_t usec = 0;
+	uint32_t usecDuration = 0;
+	int pinLevel = 0;
+	while(buttonTraffic.nextPulse(usecDuration, pinLevel)) {
+		if(usecDuration > 5000) {
+			edges[edgesCount++] = TestEdge{usec + 3000, static_cast<uint8_t>(pinLevel)};
+			edges[edgesCount++] = TestEdge{usec + 3020, static_cast<uint8_t>(not pinLevel)};
+			++glitchesCount;
+		}
+		usec += usecDuration;
+		edges[edgesCount++] = TestEdge{usec, static_cast<uint8_t>(pinLevel)};
+		assert(edgesCount + 3 < sizeof(edges) / sizeof(edges[0]));
+	}
+	assert(glitchesCount > 10);
+	const RxTimingSpecTable rxTimingSpecTable = rcSwitchProtocolTable.toTimingSpecTable();
+
+	// Without glitch filter, the glitches break the synch pulses.
+	{
+		BufferEdgeSource<Decoder<Sink<TestPipelineHandler>>> pipeline;
+		pipeline.begin(rxTimingSpecTable);
+		TestPipelineHandler::reset();
+		pipeline.feed(edges, edgesCount);
+		assert(TestPipelineHandler::mPacketsCount == 0);
+	}
+
+	// The glitch filter restores all packets.
+	size_t packetsCount = 0;
+	{
+		BufferEdgeSource<GlitchFilter<80, Decoder<Sink<TestPipelineHandler>>>> pipeline;
+		pipeline.begin(rxTimingSpecTable);
+		TestPipelineHandler::reset();
+		pipeline.feed(edges, edgesCount);
+		packetsCount = TestPipelineHandler::mPacketsCount;
+		assert(packetsCount >= 2 * buttonPressesCount);
+	}
+
+	// Each button press is passed on once. Presses of the same button
+	// within the release time are dropped.
+	{
+		BufferEdgeSource<
+			GlitchFilter<80,
+			Decoder<
+			RepeatConfirmer<2, 250000,
+			Mapper<TestPipelineButtons,
+			Sink<TestPipelineHandler>>>>>> pipeline;
+		pipeline.begin(rxTimingSpecTable);
+		TestPipelineHandler::reset();
+		pipeline.feed(edges, edgesCount);
+		assert(TestPipelineHandler::mButtonsCount == 3);
+		assert(TestPipelineHandler::mButtons[0] == 'A');
+		assert(TestPipelineHandler::mButtons[1] == 'B');
+		assert(TestPipelineHandler::mButtons[2] == 'A');
+		assert(TestPipelineHandler::mPacketsCount == 0);
+	}
+
+	// The glitch filter removes the 10 usec pulse and passes its held back
+	// last edge on at the end of the input.
+	{
+		static const TestEdge glitchEdges[] = {{1000, 0}, {2000, 1}, {2010, 0}, {3000, 1}};
+		BufferEdgeSource<GlitchFilter<80, TestEdgeRecorder>> pipeline;
+		pipeline.begin(rxTimingSpecTable);
+		pipeline.feed(glitchEdges, sizeof(glitchEdges) / sizeof(glitchEdges[0]));
+		const TestEdgeRecorder& recorder = pipeline.next().next();
+		assert(recorder.mEdgesCount == 2);
+		assert(recorder.mEdges[0].mUsec == 1000);
+		assert(recorder.mEdges[1].mUsec == 3000);
+		assert(recorder.mEdges[1].mPinLevel == 1);
+	}
+}
+
+namespace {
+
+/** Fill the message packet with the given number of bits of value, most significant bit first. */
+void toMessagePacket(MessagePacket& packet, const uint32_t value, const size_t bitsCount) {
+	packet.reset();
+	for(size_t i = bitsCount; i > 0; i--) {
+		packet.push((value >> (i - 1)) & 1 ? DATA_BIT::LOGICAL_1 : DATA_BIT::LOGICAL_0);
+	}
+}
+
+class CountingPacketSink : public MultiChannelPacketSink {
+public:
+	size_t mPacketsCount = 0;
+	receivedValue_t mLastValue = 0;
+
+	void onPacket(const size_t channel, const MultiChannelPacket& packet) override {
+		(void)channel;
+		++mPacketsCount;
+		mLastValue = packet.mValues[0];
+	}
+};
+
+/** PT2262 tri-state codes, whose last symbol is a '1'. */
+static const RxProtocolTable <
+	//               #, clk,  %, syA,  syB,  d0A,d0B,  d1A,d1B, inverseLevel, packetValidation
+	makeTimingSpec<  1, 350, 20,   1,   31,    1,  3,    3,  1, false, AllOf<TriState, FixedBits<0x003, 0x003, 12>>>
+> validatingProtocolTable;
+
+/** PT2262 frames of 32 bits, whose last bit is a 1. */
+static const RxProtocolTable <
+	//               #, clk,  %, syA,  syB,  d0A,d0B,  d1A,d1B, inverseLevel, packetValidation
+	makeTimingSpec<  1, 350, 20,   1,   31,    1,  3,    3,  1, false, FixedBits<0x1, 0x1, 32>>
+> fixedSizeProtocolTable;
+
+/**
+ * Send 4 PT2262 frames of bitsCount one bits, followed by a synch pulse
+ * pair, to the receivers. Returns the number of packets of the receiver.
+ */
+size_t sendOneBitsFrames(Receiver& receiver, MultiChannelReceiver<1>& multiChannelReceiver,
+		const size_t bitsCount) {
+	size_t packetsCount = 0;
+	uint32_t usec = 0;
+	for(size_t frame = 0; frame <= 4; frame++) {
+		for(size_t pair = 0; pair <= (frame < 4 ? bitsCount : 0); pair++) {
+			// The first pulse of a pair is a hi pulse.
+			const uint32_t usecDurations[] = {pair ? 3 * 350u : 350u, pair ? 350u : 31 * 350u};
+			for(size_t i = 0; i < 2; i++) {
+				usec += usecDurations[i];
+				ReceiverTestAccess::handleInterrupt(receiver, i, usec);
+				multiChannelReceiver.handleEdge(0, i, usec);
+				if(receiver.available()) {
+					assert(receiver.receivedBitsCount() == bitsCount);
+					++packetsCount;
+					receiver.resetAvailable();
+				}
+			}
+		}
+	}
+	return packetsCount;
+}
+
+} // anonymous namespace
+
+void RcSwitch_test::testPacketValidation() const {
+	MessagePacket packet;
+
+	toMessagePacket(packet, 0x0C3, 12);
+	assert((FixedBits<0x0F3, 0x0C3>::validate(packet)));
+	assert((FixedBits<0x0F3, 0x0C3, 12>::validate(packet)));
+	assert(not (FixedBits<0x0F3, 0x0C3, 24>::validate(packet)));
+	assert(not (FixedBits<0x0F3, 0x0C2>::validate(packet)));
+	assert(TriState::validate(packet));
+	toMessagePacket(packet, 0x083, 12);			// Pair 10 within the code.
+	assert(not TriState::validate(packet));
+	toMessagePacket(packet, 0x0C3, 11);			// Odd bits count.
+	assert(not TriState::validate(packet));
+
+	toMessagePacket(packet, 0x0C3, 12);			// 4 ones.
+	assert((Parity<>::validate(packet)));
+	assert(not (Parity<0, 0, true>::validate(packet)));
+	assert((Parity<2, 3, true>::validate(packet)));
+	assert(not (Parity<8, 8>::validate(packet)));	// Beyond the last bit.
+
+	toMessagePacket(packet, 0x1236, 16);		// Nibble sum 1 + 2 + 3 = 6.
+	assert((Checksum<0, 4, 3>::validate(packet)));
+	toMessagePacket(packet, 0x1235, 16);
+	assert(not (Checksum<0, 4, 3>::validate(packet)));
+	toMessagePacket(packet, 0x1236, 16);
+	assert(not (Checksum<4, 4, 3>::validate(packet)));	// Beyond the last bit.
+	toMessagePacket(packet, 0xF02010, 24);		// Byte sum 0xF0 + 0x20 overflows.
+	assert((Checksum<0, 8, 2>::validate(packet)));
+	toMessagePacket(packet, 0xF02110, 24);
+	assert(not (Checksum<0, 8, 2>::validate(packet)));
+
+	toMessagePacket(packet, 0xA53C30, 24);		// CRC-8 0x31 of 0xA5 0x3C is 0x30.
+	assert((Crc8<0x31>::validate(packet)));
+	assert(not (Crc8<0x31, 0xFF>::validate(packet)));
+	toMessagePacket(packet, 0x853C30, 24);
+	assert(not (Crc8<0x31>::validate(packet)));
+	toMessagePacket(packet, 0xFA53C30, 28);		// Skip a leading nibble.
+	assert((Crc8<0x31, 0x00, 4>::validate(packet)));
+
+	toMessagePacket(packet, 0x0C3, 12);
+	assert((AllOf<>::validate(packet)));
+	assert((AllOf<TriState, Parity<>>::validate(packet)));
+	assert(not (AllOf<TriState, Parity<0, 0, true>>::validate(packet)));
+
+	// Invalid packets do not become available.
+	static const ButtonTrafficSource::ButtonPress buttonPresses[] = {
+		{0x0C3, 12, 4, 100000},	// valid
+		{0x083, 12, 4, 100000},	// Invalid tri-state code
+		{0x0C0, 12, 4, 100000},	// Invalid last symbol
+		{0x0C3, 10, 4, 100000},	// Invalid bits count
+	};
+	constexpr size_t buttonPressesCount = sizeof(buttonPresses) / sizeof(buttonPresses[0]);
+
+	for(size_t pass = 0; pass < 2; pass++) {
+		const bool bValidating = pass == 0;
+		const RxTimingSpecTable rxTimingSpecTable = bValidating ?
+				validatingProtocolTable.toTimingSpecTable() : rcSwitchProtocolTable.toTimingSpecTable();
+		ButtonTrafficSource buttonTraffic(350, 1, 31, 1, 3, 3, 1, false,
+				buttonPresses, buttonPressesCount, 1);
+		Receiver receiver;
+		receiver.setRxTimingSpecTable(rxTimingSpecTable);
+		CountingPacketSink packetSink;
+		MultiChannelReceiver<1> multiChannelReceiver;
+		multiChannelReceiver.setRxTimingSpecTable(rxTimingSpecTable);
+		multiChannelReceiver.setPacketSink(&packetSink);
+
+		size_t packetsCount = 0;
+		size_t validPacketsCount = 0;
+		uint32_t usec = 0;
+		uint32_t usecDuration = 0;
+		int pinLevel = 0;
+		while(buttonTraffic.nextPulse(usecDuration, pinLevel)) {
+			usec += usecDuration;
+			receiver.handleInterrupt(pinLevel, usec);
+			multiChannelReceiver.handleEdge(0, pinLevel, usec);
+			if(receiver.available()) {
+				++packetsCount;
+				if(receiver.receivedBitsCount() == 12 && receiver.receivedValueAt(0) == 0x0C3) {
+					++validPacketsCount;
+				}
+				receiver.resetAvailable();
+			}
+		}
+		if(bValidating) {
+			assert(packetsCount > 0);
+			assert(packetsCount == validPacketsCount);
+			assert(packetSink.mPacketsCount == packetsCount);
+			assert(packetSink.mLastValue == 0x0C3);
+		} else {
+			assert(packetsCount > validPacketsCount);
+			assert(packetSink.mPacketsCount > packetsCount / 2);
+		}
+	}
+
+	// A validator can't check a frame, that exceeds MAX_MSG_PACKET_BITS,
+	// because the packet keeps only the first MAX_MSG_PACKET_BITS bits.
+	// So overlong frames are rejected by validating protocols only.
+	static_assert(MAX_MSG_PACKET_BITS == 32, "Test expects 32 bits packets.");
+	for(size_t pass = 0; pass < 2; pass++) {
+		const bool bValidating = pass == 0;
+		const RxTimingSpecTable rxTimingSpecTable = bValidating ?
+				fixedSizeProtocolTable.toTimingSpecTable() : rcSwitchProtocolTable.toTimingSpecTable();
+		const size_t bitsCounts[] = {32, 40};
+		for(const size_t bitsCount : bitsCounts) {
+			Receiver receiver;
+			receiver.setRxTimingSpecTable(rxTimingSpecTable);
+			CountingPacketSink packetSink;
+			MultiChannelReceiver<1> multiChannelReceiver;
+			multiChannelReceiver.setRxTimingSpecTable(rxTimingSpecTable);
+			multiChannelReceiver.setPacketSink(&packetSink);
+			const size_t packetsCount = sendOneBitsFrames(receiver, multiChannelReceiver, bitsCount);
+			if(bValidating && bitsCount > MAX_MSG_PACKET_BITS) {
+				assert(packetsCount == 0);
+			} else {
+				assert(packetsCount > 0);
+			}
+			assert(packetSink.mPacketsCount == packetsCount);
+		}
+	}
+}
+
+namespace {
+
+/** Counts the received packets per sensor. */
+class SensorPacketCounter : public VirtualTimeScheduler::LoopTask {
+	Receiver& mReceiver;
+public:
+	static constexpr size_t SENSORS_COUNT = 3;
+	const uint32_t mValues[SENSORS_COUNT] = {0x5A1, 0x3C2, 0x7E3};
+	size_t mPacketsCount[SENSORS_COUNT] = {};
+	size_t mForeignPacketsCount = 0;
+
+	SensorPacketCounter(Receiver& receiver) : mReceiver(receiver) {}
+
+	void loop() override {
+		if(mReceiver.available()) {
+			size_t i = 0;
+			for(; i < SENSORS_COUNT && mReceiver.receivedValueAt(0) != mValues[i]; i++);
+			if(i < SENSORS_COUNT) {
+				++mPacketsCount[i];
+			} else {
+				++mForeignPacketsCount;
+			}
+			mReceiver.resetAvailable();
+		}
+	}
+};
+
+} // anonymous namespace
+
+void RcSwitch_test::testReceptionScheduler() const {
+	Receiver receiver;
+	receiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+	ReceptionScheduler<4> receptionScheduler(0xF00);
+	// Rare discovery windows keep the decoded share of the edges low.
+	receptionScheduler.configure(1, 50000, 2, 32);
+	receiver.setReceptionScheduler(&receptionScheduler);
+	SensorPacketCounter packetCounter(receiver);
+
+	// 2 sensors within noise pulses, that are too short for any protocol.
+	// The third sensor starts later, always in between the bursts of the first one.
+	SensorTrafficSource::Sensor sensors[] = {
+		{0x5A1, 20000000,  3000000, true, 0},
+		{0x3C2, 27000000, 11000000, true, 0},
+		{0x7E3, 20000000, 13000000, false, 0},
+	};
+	constexpr size_t sensorsCount = sizeof(sensors) / sizeof(sensors[0]);
+	SensorTrafficSource sensorTraffic(350, 1, 31, 1, 3, 3, 1, sensors, sensorsCount, 12, 4, 20, 250);
+
+	// Start shortly before micros() wraps around.
+	VirtualClock::start(UINT32_MAX - 100000000ULL);
+	VirtualTimeScheduler scheduler(receiver, sensorTraffic, packetCounter, 1000 /* loop every msec */);
+
+	// Learn the intervals. The 4th burst of a sensor locks it.
+	scheduler.runFor(120000000);
+	assert(receptionScheduler.sourcesCount() == 2);
+	assert(receptionScheduler.sourceAt(0).isLocked());
+	assert(receptionScheduler.sourceAt(1).isLocked());
+	assert(receptionScheduler.isGating());
+
+	// Decode within the reception windows only. No burst gets lost.
+	{
+		const uint32_t edgesCount = scheduler.edgesCount();
+		const uint32_t gatedEdgesCount = receptionScheduler.gatedEdgesCount();
+		const size_t packetsCount_0 = packetCounter.mPacketsCount[0];
+		const size_t packetsCount_1 = packetCounter.mPacketsCount[1];
+		scheduler.runFor(540000000);
+		const uint32_t decodedEdgesCount = (scheduler.edgesCount() - edgesCount)
+				- (receptionScheduler.gatedEdgesCount() - gatedEdgesCount);
+		assert(10 * decodedEdgesCount < scheduler.edgesCount() - edgesCount);
+		assert(packetCounter.mPacketsCount[0] - packetsCount_0 >= 540 / 20);
+		assert(packetCounter.mPacketsCount[1] - packetsCount_1 >= 540 / 27);
+		assert(receptionScheduler.isGating());
+	}
+	assert(VirtualClock::now() > UINT32_MAX);
+
+	// A sensor that stops sending makes the receiver decode all of the time.
+	sensors[1].mActive = false;
+	scheduler.runFor(120000000);
+	assert(not receptionScheduler.isGating());
+	{
+		const uint32_t gatedEdgesCount = receptionScheduler.gatedEdgesCount();
+		const size_t packetsCount_0 = packetCounter.mPacketsCount[0];
+		scheduler.runFor(60000000);
+		assert(receptionScheduler.gatedEdgesCount() == gatedEdgesCount);
+		assert(packetCounter.mPacketsCount[0] - packetsCount_0 >= 60 / 20);
+	}
+
+	// The silent sensor is forgotten, the other one is still locked.
+	scheduler.runFor(RECEPTION_USEC_FORGET);
+	assert(receptionScheduler.sourcesCount() == 1);
+	assert(receptionScheduler.sourceAt(0).mId == 0x500);
+	assert(receptionScheduler.isGating());
+
+	// A new sensor starts sending between the reception windows. It is heard
+	// within a discovery window, which opens every 4 intervals of the locked
+	// sensor for one interval.
+	receptionScheduler.configure(1, 50000, 2, 4);
+	sensors[2].mActive = true;
+	scheduler.runFor(300000000);
+	assert(receptionScheduler.sourcesCount() == 2);
+	assert(receptionScheduler.sourceAt(1).mId == 0x700);
+	assert(receptionScheduler.isGating());
+	assert(packetCounter.mPacketsCount[2] > 0);
+
+	// A reset request takes effect immediately. The sources are forgotten
+	// with the next packet and learned again.
+	receptionScheduler.requestReset();
+	assert(not receptionScheduler.isGating());
+	scheduler.runFor(30000000);
+	assert(receptionScheduler.sourcesCount() > 0);
+	assert(not receptionScheduler.sourceAt(0).isLocked());
+	scheduler.runFor(120000000);
+	assert(receptionScheduler.sourcesCount() == 2);
+	assert(receptionScheduler.isGating());
+	assert(packetCounter.mForeignPacketsCount == 0);
+	VirtualClock::stop();
+}
+
+void RcSwitch_test::testReceptionWindows() const {
+	// The reception window of a sensor with a long interval has a wide
+	// guard time. It contains the windows of a sensor with a short interval.
+	{
+		Receiver receiver;
+		receiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+		ReceptionScheduler<4> receptionScheduler(0xF00);
+		receptionScheduler.configure(5, 100000, 2, 0);
+		receiver.setReceptionScheduler(&receptionScheduler);
+		SensorPacketCounter packetCounter(receiver);
+
+		SensorTrafficSource::Sensor sensors[] = {
+			{0x5A1, 300000000,       0, true, 0},
+			{0x3C2,  10000000, 5000000, true, 0},
+		};
+		constexpr size_t sensorsCount = sizeof(sensors) / sizeof(sensors[0]);
+		SensorTrafficSource sensorTraffic(350, 1, 31, 1, 3, 3, 1, sensors, sensorsCount, 12, 4, 20, 250);
+		VirtualClock::start();
+		VirtualTimeScheduler scheduler(receiver, sensorTraffic, packetCounter, 1000 /* loop every msec */);
+
+		// The 4th burst of the long interval sensor locks it.
+		scheduler.runFor(1000000000);
+		assert(receptionScheduler.sourcesCount() == 2);
+		assert(receptionScheduler.isGating());
+
+		// No burst of the long interval sensor is cut off.
+		const size_t packetsCount_0 = packetCounter.mPacketsCount[0];
+		scheduler.runFor(2400000000);
+		assert(packetCounter.mPacketsCount[0] - packetsCount_0 >= 2400 / 300);
+		assert(receptionScheduler.isGating());
+		for(size_t i = 0; i < receptionScheduler.sourcesCount(); i++) {
+			assert(receptionScheduler.sourceAt(i).isLocked());
+			assert(receptionScheduler.sourceAt(i).mMisses == 0);
+		}
+		assert(packetCounter.mForeignPacketsCount == 0);
+		VirtualClock::stop();
+	}
+
+	// A pulse received before a window has closed is not paired with the
+	// first pulse after the next window has opened.
+	{
+		Receiver receiver;
+		receiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
+		ReceptionScheduler<1> receptionScheduler;
+		receptionScheduler.configure(1, 50000, 2, 0);
+		receiver.setReceptionScheduler(&receptionScheduler);
+
+		// Bursts every second lock the source with the 4th burst.
+		for(uint32_t usec = 1000000; usec <= 4000000; usec += 1000000) {
+			receptionScheduler.addPacket(1, 0, usec);
+		}
+		assert(receptionScheduler.isGating());
+
+		// Within the window of the current burst.
+		receiver.handleInterrupt(1, 4000100);
+		assert(receiver.state() == Receiver::SYNC_STATE);
+		assert(receiver.size() == 1);
+		// Between the windows.
+		receiver.handleInterrupt(0, 4500000);
+		assert(receiver.size() == 0);
+		// Within the window of the next burst.
+		receiver.handleInterrupt(1, 4990000);
+		assert(receiver.size() == 1);
+	}
+}
+
 void RcSwitch_test::testSynchRx() const {
 	Receiver receiver;
-	receiver.setRxTimingSpecTable(rxProtocolTable.toTimingSpecTable());
+	receiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
 	uint32_t usec = 0;
 
 	usec += 100;  // lo pulse  100 usec duration.
@@ -365,7 +1784,7 @@ void RcSwitch_test::testSynchRx() const {
 
 void RcSwitch_test::testProtocolCandidates() const {
 	Receiver receiver;
-	receiver.setRxTimingSpecTable(rxProtocolTable.toTimingSpecTable());
+	receiver.setRxTimingSpecTable(rcSwitchProtocolTable.toTimingSpecTable());
 
 	Pulse pulse_0 = {				// Hi level pulse too short
 			239, PULSE_LEVEL::HI
@@ -84,6 +84,21 @@ private:
 	void testSynchRx() const;
 	void testDataRx() const;
 	void testFaultyDataRx() const;
+	void testPacketStream() const;
+	void testDecoderEventLog() const;
+	void testPacketQuality() const;
+	void testSharedPulseTracer() const;
+	void testButtonPressDebounce() const;
+	void testMultiChannelReceiver() const;
+	void testTimingTuner() const;
+	void testTimingSpecOptimizer() const;
+	void testBandMonitor() const;
+	void testPacketStore() const;
+	void testReferenceReceiver() const;
+	void testPipeline() const;
+	void testPacketValidation() const;
+	void testReceptionScheduler() const;
+	void testReceptionWindows() const;
 
 public:
 	void run() const{
@@ -93,6 +108,21 @@ public:
 		testSynchRx();
 		testDataRx();
 		testFaultyDataRx();
+		testPacketStream();
+		testDecoderEventLog();
+		testPacketQuality();
+		testSharedPulseTracer();
+		testButtonPressDebounce();
+		testMultiChannelReceiver();
+		testTimingTuner();
+		testTimingSpecOptimizer();
+		testBandMonitor();
+		testPacketStore();
+		testReferenceReceiver();
+		testPipeline();
+		testPacketValidation();
+		testReceptionScheduler();
+		testReceptionWindows();
 	}
 
 	static RcSwitch_test theTest;
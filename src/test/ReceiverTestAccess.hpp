@@ -0,0 +1,77 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_TEST_RECEIVERTESTACCESS_HPP_
+#define RCSWITCH_RECEIVER_TEST_RECEIVERTESTACCESS_HPP_
+
+#ifdef ENABLE_RCSWITCH_TEST
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../internal/RcSwitch.hpp"
+
+namespace RcSwitch {
+
+/**
+ * Gives the test harnesses access to the receiver methods, that the API
+ * class RcSwitchReceiver uses. So the receiver befriends this class only,
+ * instead of every harness.
+ */
+class ReceiverTestAccess {
+public:
+	enum STATE : size_t {
+		AVAILABLE_STATE = Receiver::AVAILABLE_STATE,
+		SYNC_STATE = Receiver::SYNC_STATE,
+		DATA_STATE = Receiver::DATA_STATE,
+	};
+
+	static void setRxTimingSpecTable(Receiver& receiver, const RxTimingSpecTable& rxTimingSpecTable) {
+		receiver.setRxTimingSpecTable(rxTimingSpecTable);
+	}
+
+	static void handleInterrupt(Receiver& receiver, const int pinLevel, const uint32_t usecInterruptEntry) {
+		receiver.handleInterrupt(pinLevel, usecInterruptEntry);
+	}
+
+	static STATE state(const Receiver& receiver) {
+		return static_cast<STATE>(receiver.state());
+	}
+};
+
+/** A receiver, that the test harnesses can construct. */
+class TestReceiver : public Receiver {
+public:
+	TestReceiver() {
+	}
+};
+
+} // namespace RcSwitch
+
+#endif // #ifdef ENABLE_RCSWITCH_TEST
+
+#endif /* RCSWITCH_RECEIVER_TEST_RECEIVERTESTACCESS_HPP_ */
@@ -0,0 +1,302 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#include "ReferenceReceiver.hpp"
+#ifdef ENABLE_RCSWITCH_TEST
+
+#undef min
+#undef max
+
+namespace RcSwitch {
+
+namespace {
+
+PulseTypes pulseAtoPulseTypes(const RxTimingSpec& protocol, const Pulse &pulse) {
+	PulseTypes result = { PULSE_TYPE::UNKNOWN, PULSE_TYPE::UNKNOWN };
+	{
+		const TimeRange::COMPARE_RESULT synchCompare =
+				protocol.synchronizationPulsePair.durationA.compare(pulse.getDuration());
+
+		/* First synch pulse is allowed to be longer */
+		if (synchCompare != TimeRange::TOO_SHORT) {
+			result.mPulseTypeSynch = PULSE_TYPE::SYNCH_FIRST_PULSE;
+		}
+	}
+
+	{
+		const TimeRange::COMPARE_RESULT log0Compare =
+				protocol.data0pulsePair.durationA.compare(pulse.getDuration());
+
+		if (log0Compare == TimeRange::IS_WITHIN) {
+			result.mPulseTypeData = PULSE_TYPE::DATA_LOGICAL_00;
+		} else {
+			const TimeRange::COMPARE_RESULT log1Compare =
+					protocol.data1pulsePair.durationA.compare(pulse.getDuration());
+			if (log1Compare == TimeRange::IS_WITHIN) {
+				result.mPulseTypeData = PULSE_TYPE::DATA_LOGICAL_01;
+			}
+		}
+	}
+	return result;
+}
+
+PulseTypes pulseBtoPulseTypes(const RxTimingSpec& protocol, const Pulse &pulse) {
+	PulseTypes result = { PULSE_TYPE::UNKNOWN, PULSE_TYPE::UNKNOWN };
+	{
+		const TimeRange::COMPARE_RESULT synchCompare =
+				protocol.synchronizationPulsePair.durationB.compare(pulse.getDuration());
+
+		if (synchCompare == TimeRange::IS_WITHIN) {
+			result.mPulseTypeSynch = PULSE_TYPE::SYNCH_SECOND_PULSE;
+		}
+	}
+
+	{
+		const TimeRange::COMPARE_RESULT log0Compare =
+				protocol.data0pulsePair.durationB.compare(pulse.getDuration());
+
+		if (log0Compare == TimeRange::IS_WITHIN) {
+			result.mPulseTypeData = PULSE_TYPE::DATA_LOGICAL_00;
+		} else {
+			const TimeRange::COMPARE_RESULT log1Compare =
+					protocol.data1pulsePair.durationB.compare(pulse.getDuration());
+			if (log1Compare == TimeRange::IS_WITHIN) {
+				result.mPulseTypeData = PULSE_TYPE::DATA_LOGICAL_01;
+			}
+		}
+	}
+	return result;
+}
+
+void collectProtocolCandidates(const RxTimingSpecTable& protocol,
+		ProtocolCandidates& protocolCandidates, const Pulse&  pulseA, const Pulse&  pulseB) {
+	for(size_t i = 0; i < protocol.size; i++) {
+		const RxTimingSpec& prot = protocol.start[i];
+		if(pulseA.getDuration() <
+				protocol.start[i].synchronizationPulsePair.durationA.lowerBound) {
+			/* Protocols are sorted in ascending order of synchronization
+			 * pulseA lower bound. */
+			return;
+		}
+
+		if(pulseA.getDuration() <
+				prot.synchronizationPulsePair.durationA.upperBound) {
+			if(pulseB.getDuration() >=
+					prot.synchronizationPulsePair.durationB.lowerBound) {
+				if(pulseB.getDuration() <
+						prot.synchronizationPulsePair.durationB.upperBound) {
+					protocolCandidates.push(i);
+				}
+			}
+		}
+	}
+}
+
+} // anonymous namespace
+
+void ReferenceReceiver::collectProtocolCandidates(const Pulse&  pulse_0, const Pulse&  pulse_1) {
+	if(pulse_0.getLevel() != pulse_1.getLevel()) {
+		if(pulse_0.getLevel() == PULSE_LEVEL::HI) {
+			mProtocolCandidates.setProtocolGroup(NORMAL_LEVEL_PROTOCOLS);
+			RcSwitch::collectProtocolCandidates(getRxTimingTable(NORMAL_LEVEL_PROTOCOLS), mProtocolCandidates, pulse_0, pulse_1);
+		} else if(pulse_0.getLevel() == PULSE_LEVEL::LO) {
+			mProtocolCandidates.setProtocolGroup(INVERSE_LEVEL_PROTOCOLS);
+			RcSwitch::collectProtocolCandidates(getRxTimingTable(INVERSE_LEVEL_PROTOCOLS), mProtocolCandidates, pulse_0, pulse_1);
+		}
+	}
+}
+
+PULSE_TYPE ReferenceReceiver::analyzePulsePair(const Pulse& pulseA, const Pulse& pulseB) {
+	PULSE_TYPE result = PULSE_TYPE::UNKNOWN;
+	const RxTimingSpecTable protocols = getRxTimingTable(mProtocolCandidates.getProtocolGroup());
+	size_t protocolCandidatesIndex = mProtocolCandidates.size();
+	while(protocolCandidatesIndex > 0) {
+		--protocolCandidatesIndex;
+		const RxTimingSpec& protocol = protocols.start[mProtocolCandidates[protocolCandidatesIndex]];
+
+		const PulseTypes& pulseTypesPulseA = pulseAtoPulseTypes(protocol, pulseA);
+		const PulseTypes& pulseTypesPulseB = pulseBtoPulseTypes(protocol, pulseB);
+
+		if(pulseTypesPulseB.mPulseTypeSynch == PULSE_TYPE::SYNCH_SECOND_PULSE
+				&& pulseTypesPulseA.mPulseTypeSynch == PULSE_TYPE::SYNCH_FIRST_PULSE) {
+			/* The pulses match the protocol for synch pulses. */
+			return PULSE_TYPE::SYCH_PULSE;
+		}
+
+		if(pulseTypesPulseB.mPulseTypeData == pulseTypesPulseA.mPulseTypeData
+				&& pulseTypesPulseB.mPulseTypeData !=  PULSE_TYPE::UNKNOWN) {
+			/* The pulses match the protocol for data pulses */
+			if(result == PULSE_TYPE::UNKNOWN) { /* keep the first match */
+				result = pulseTypesPulseB.mPulseTypeData;
+			}
+		} else {
+			// The pulses do not match the protocol
+			mProtocolCandidates.remove(protocolCandidatesIndex);
+		}
+	}
+	return result;
+}
+
+void ReferenceReceiver::handleInterrupt(const int pinLevel, const uint32_t usecInterruptEntry) {
+	const uint32_t usecDuration = usecInterruptEntry - mUsecLastInterrupt;
+	push(usecDuration, pinLevel);
+
+	switch(state()) {
+		case SYNC_STATE:
+			if(size() > 1) {
+				collectProtocolCandidates(at(size()-2), at(size()-1));
+			}
+			break;
+		case DATA_STATE:
+			if(++mDataModePulseCount == 2) {
+				mDataModePulseCount = 0;
+				const Pulse& pulseA = at(size()-2);
+				const Pulse& pulseB = at(size()-1);
+				const PULSE_TYPE pulseType = analyzePulsePair(pulseA, pulseB);
+				if(pulseType == PULSE_TYPE::UNKNOWN) {
+					/* Unknown pulses received, hence start from scratch. Current pulses
+					 * might be the synch start, but for a different protocol. */
+					mProtocolCandidates.reset();
+					collectProtocolCandidates(pulseA, pulseB);
+					retry();
+				} else if(pulseType == PULSE_TYPE::SYCH_PULSE) {
+					/* The 2 pulses are a new sync start, we are finished
+					 * with the current message package */
+					if(mReceivedMessagePacket.size() >= MIN_MSG_PACKET_BITS) {
+						mMessageAvailable = true;
+					} else {
+						mProtocolCandidates.reset();
+						collectProtocolCandidates(pulseA, pulseB);
+						retry();
+					}
+				} else {
+					mReceivedMessagePacket.push(pulseType == PULSE_TYPE::DATA_LOGICAL_00 ?
+							DATA_BIT::LOGICAL_0 : DATA_BIT::LOGICAL_1);
+				}
+			}
+			break;
+		case AVAILABLE_STATE:
+			/* Do nothing. */
+			break;
+	}
+	mUsecLastInterrupt = usecInterruptEntry;
+}
+
+void ReferenceReceiver::push(uint32_t microSecDuration, const int pinLevel) {
+	Pulse * const storage = beyondTop();
+	*storage = Pulse(microSecDuration, (pinLevel ? PULSE_LEVEL::LO : PULSE_LEVEL::HI));
+	baseClass::selectNext();
+}
+
+ReferenceReceiver::STATE ReferenceReceiver::state() const {
+	if (mMessageAvailable) {
+		return AVAILABLE_STATE;
+	}
+	return mProtocolCandidates.size() ? DATA_STATE : SYNC_STATE;
+}
+
+void ReferenceReceiver::retry() {
+	mReceivedMessagePacket.reset();
+	baseClass::reset();
+}
+
+void ReferenceReceiver::reset() {
+	mProtocolCandidates.reset();
+	mReceivedMessagePacket.reset();
+	baseClass::reset();
+	mMessageAvailable = false;
+}
+
+size_t ReferenceReceiver::receivedBitsCount() const {
+	if(available()) {
+		return mReceivedMessagePacket.size() + mReceivedMessagePacket.overflowCount();
+	}
+	return 0;
+}
+
+size_t ReferenceReceiver::receivedValuesCount() const {
+	if(available()) {
+		const size_t receivedCount = (receivedBitsCount() + 8 * sizeof(receivedValue_t) - 1) / (8 * sizeof(receivedValue_t));
+		return receivedCount < RCSWITCH_UINT32_ARRAY_SIZE ? receivedCount : RCSWITCH_UINT32_ARRAY_SIZE;
+	}
+	return 0;
+}
+
+receivedValue_t ReferenceReceiver::receivedValueAt(const size_t index) const {
+	receivedValue_t result = 0;
+	if(available()) {
+		const size_t totalBitCount = mReceivedMessagePacket.size();
+		const size_t remainingBits = totalBitCount % (8 * sizeof(result));
+
+		const size_t bitPosEnd = (((index + 1) < receivedValuesCount()) || not remainingBits) ?
+				(index + 1) * 8 * sizeof(receivedValue_t) : index * 8 * sizeof(receivedValue_t) + remainingBits;
+
+		for(size_t bitPos = index * 8 * sizeof(receivedValue_t); bitPos < bitPosEnd; bitPos++) {
+			result = result << 1;
+			if(mReceivedMessagePacket.at(bitPos) == DATA_BIT::LOGICAL_1) {
+				result |= 1;
+			}
+		}
+	}
+	return result;
+}
+
+int ReferenceReceiver::receivedProtocol(const size_t index) const {
+	if(index < mProtocolCandidates.size()) {
+		const RxTimingSpecTable& protocol = getRxTimingTable(mProtocolCandidates.getProtocolGroup());
+		return protocol.start[mProtocolCandidates.at(index)].protocolNumber;
+	}
+	return -1;
+}
+
+RxTimingSpecTable ReferenceReceiver::getRxTimingTable(PROTOCOL_GROUP_ID protocolGroup) const {
+	switch (protocolGroup) {
+	case PROTOCOL_GROUP_ID::NORMAL_LEVEL_PROTOCOLS:
+		return mRxTimingSpecTableNormal;
+	case PROTOCOL_GROUP_ID::INVERSE_LEVEL_PROTOCOLS:
+		return mRxTimingSpecTableInverse;
+	case PROTOCOL_GROUP_ID::UNKNOWN_PROTOCOL:
+		break;
+	}
+	return RxTimingSpecTable{nullptr, 0};
+}
+
+void ReferenceReceiver::setRxTimingSpecTable(const RxTimingSpecTable& rxTimingSpecTable) {
+	size_t i = 0;
+	/* Inverse level protocols reside at the end of the table. */
+	for (; i < rxTimingSpecTable.size; i++) {
+		if (rxTimingSpecTable.start[i].bInverseLevel) {
+			break;
+		}
+	}
+	mRxTimingSpecTableNormal.start = &rxTimingSpecTable.start[0];
+	mRxTimingSpecTableNormal.size = i;
+	mRxTimingSpecTableInverse.start = &rxTimingSpecTable.start[i];
+	mRxTimingSpecTableInverse.size = rxTimingSpecTable.size - i;
+}
+
+} // namespace RcSwitch
+
+#endif // #ifdef ENABLE_RCSWITCH_TEST
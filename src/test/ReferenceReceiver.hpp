@@ -0,0 +1,101 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_TEST_REFERENCERECEIVER_HPP_
+#define RCSWITCH_RECEIVER_TEST_REFERENCERECEIVER_HPP_
+
+#ifdef ENABLE_RCSWITCH_TEST
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../internal/RcSwitch.hpp"
+
+namespace RcSwitch {
+
+/**
+ * A frozen copy of the decoding of class Receiver. It is the reference
+ * model, that optimized decoding engines are checked against. Refer to
+ * class RcSwitch_differential.
+ *
+ * Only the parts of the Receiver that determine the received packets are
+ * copied: handleInterrupt(), analyzePulsePair() and
+ * collectProtocolCandidates() with the states they act on. Packet
+ * streaming, timing tuning, band monitoring, the decoder event log and
+ * the packet quality are left out.
+ *
+ * Don't optimize this class. Change it only together with an intended
+ * change of the decoding behavior of the Receiver.
+ */
+class ReferenceReceiver : public RingBuffer<Pulse, DATA_PULSES_PER_BIT> {
+	using baseClass = RingBuffer<Pulse, DATA_PULSES_PER_BIT>;
+
+	uint32_t mUsecLastInterrupt;
+	ProtocolCandidates mProtocolCandidates;
+	uint8_t mDataModePulseCount;
+	bool mMessageAvailable;
+	RxTimingSpecTable mRxTimingSpecTableNormal;
+	RxTimingSpecTable mRxTimingSpecTableInverse;
+	MessagePacket mReceivedMessagePacket;
+
+	enum STATE {AVAILABLE_STATE, SYNC_STATE, DATA_STATE};
+	enum STATE state() const;
+
+	RxTimingSpecTable getRxTimingTable(PROTOCOL_GROUP_ID protocolGroup) const;
+	void collectProtocolCandidates(const Pulse&  pulse_0, const Pulse&  pulse_1);
+	void push(uint32_t usecDuration, const int pinLevel);
+	PULSE_TYPE analyzePulsePair(const Pulse& firstPulse, const Pulse& secondPulse);
+	void retry();
+	void reset();
+
+public:
+	ReferenceReceiver()
+		: mUsecLastInterrupt(0), mDataModePulseCount(0), mMessageAvailable(false)
+		, mRxTimingSpecTableNormal{nullptr, 0}, mRxTimingSpecTableInverse{nullptr, 0} {
+	}
+
+	void setRxTimingSpecTable(const RxTimingSpecTable& rxTimingSpecTable);
+	void handleInterrupt(const int pinLevel, const uint32_t usecInterruptEntry);
+
+	/**
+	 * For the following methods, refer to the corresponding methods of
+	 * class Receiver.
+	 */
+	inline bool available() const {return state() == AVAILABLE_STATE;}
+	size_t receivedValuesCount() const;
+	receivedValue_t receivedValueAt(const size_t index) const;
+	size_t receivedBitsCount() const;
+	inline size_t receivedProtocolCount() const {return mProtocolCandidates.size();}
+	int receivedProtocol(const size_t index) const;
+	void resetAvailable() {if(available()) {reset();}}
+};
+
+} // namespace RcSwitch
+
+#endif // #ifdef ENABLE_RCSWITCH_TEST
+
+#endif /* RCSWITCH_RECEIVER_TEST_REFERENCERECEIVER_HPP_ */
@@ -0,0 +1,77 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_TEST_TESTFIXTURES_HPP_
+#define RCSWITCH_RECEIVER_TEST_TESTFIXTURES_HPP_
+
+#ifdef ENABLE_RCSWITCH_TEST
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../internal/ISR_ATTR.hpp"
+#include "../internal/ProtocolTimingSpec.hpp"
+#include "../RcSwitchPipeline.hpp"
+
+/**
+ * Protocol tables and the edge format, that are shared by the tests, the
+ * benchmarks and example sketch BenchmarkAvrCycles.ino.
+ */
+
+namespace RcSwitch {
+
+DATA_ISR_ATTR static const RxProtocolTable <
+	//               #, clk,  %, syA,  syB,  d0A,d0B,  d1A,d1B, inverseLevel
+	makeTimingSpec<  1, 350, 20,   1,   31,    1,  3,    3,  1, false>, // (PT2262)
+	makeTimingSpec<  2, 650, 20,   1,   10,    1,  3,    3,  1, false>, // ()
+	makeTimingSpec<  3, 100, 20,  30,   71,    4, 11,    9,  6, false>, // ()
+	makeTimingSpec<  4, 380, 20,   1,    6,    1,  3,    3,  1, false>, // ()
+	makeTimingSpec<  5, 500, 20,   6,   14,    1,  2,    2,  1, false>, // ()
+	makeTimingSpec<  6, 450, 20,   1,   23,    1,  2,    2,  1, true>, 	// (HT6P20B)
+	makeTimingSpec<  7, 150, 20,   2,   62,    1,  6,    6,  1, false>, // (HS2303-PT)
+	makeTimingSpec<  8, 200, 20,   3,  130,    7, 16,    3, 16, false>, // (Conrad RS-200)
+	makeTimingSpec<  9, 365, 20,   1,   18,    3,  1,    1,  3, true>, 	// (1ByOne Doorbell)
+	makeTimingSpec< 10, 270, 20,   1,   36,    1,  2,    2,  1, true>, 	// (HT12E)
+	makeTimingSpec< 11, 320, 20,   1,   36,    1,  2,    2,  1, true>  	// (SM5212)
+> rcSwitchProtocolTable;
+
+DATA_ISR_ATTR static const RxProtocolTable <
+	//               #, clk,  %, syA,  syB,  d0A,d0B,  d1A,d1B, inverseLevel
+	makeTimingSpec<  1, 350, 20,   1,   31,    1,  3,    3,  1, false>  // (PT2262)
+> pt2262ProtocolTable;
+
+/**
+ * A recorded or generated pin level change. It is the edge of the
+ * pipeline, so that the same edges can be fed to a BufferEdgeSource.
+ */
+typedef PipelineEdge TestEdge;
+
+} // namespace RcSwitch
+
+#endif // #ifdef ENABLE_RCSWITCH_TEST
+
+#endif /* RCSWITCH_RECEIVER_TEST_TESTFIXTURES_HPP_ */
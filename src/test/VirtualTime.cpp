@@ -0,0 +1,228 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#include "VirtualTime.hpp"
+#ifdef ENABLE_RCSWITCH_TEST
+
+#include "ReceiverTestAccess.hpp"
+
+namespace RcSwitch {
+
+uint64_t VirtualClock::mUsecNow = 0;
+
+void VirtualClock::start(const uint64_t usecNow) {
+	mUsecNow = usecNow;
+	usecTimeHook = &VirtualClock::now;
+}
+
+void VirtualClock::stop() {
+	usecTimeHook = nullptr;
+}
+
+bool VirtualClock::isActive() {
+	return usecTimeHook == &VirtualClock::now;
+}
+
+ButtonTrafficSource::ButtonTrafficSource(const uint32_t usecClock, const uint32_t synchA, const uint32_t synchB,
+		const uint32_t data0A, const uint32_t data0B, const uint32_t data1A, const uint32_t data1B,
+		const bool inverseLevel, const ButtonPress* buttonPresses, const size_t buttonPressesCount,
+		const size_t cyclesCount)
+	: mUsecSynchA(usecClock * synchA), mUsecSynchB(usecClock * synchB)
+	, mUsecData0A(usecClock * data0A), mUsecData0B(usecClock * data0B)
+	, mUsecData1A(usecClock * data1A), mUsecData1B(usecClock * data1B)
+	, mFirstPulseEndLevel(inverseLevel ? 1 : 0)
+	, mButtonPresses(buttonPresses), mButtonPressesCount(buttonPressesCount), mCyclesCount(cyclesCount)
+	, mCycle(0), mPressIndex(0), mPairIndex(0), mSecondPulse(false) {
+}
+
+/**
+ * A button press consists of mRepeats times a synch pulse pair followed by
+ * the data pulse pairs. Another synch pulse pair completes the last message
+ * packet. The final pulse pair holds the pause.
+ */
+void ButtonTrafficSource::pulsePair(const ButtonPress& press, uint32_t& usecA, uint32_t& usecB) const {
+	const size_t pairsPerPacket = press.mBitsCount + 1;
+	const size_t packet = mPairIndex / pairsPerPacket;
+	const size_t pair = mPairIndex % pairsPerPacket;
+	if(packet < press.mRepeats) {
+		if(pair == 0) {
+			usecA = mUsecSynchA;
+			usecB = mUsecSynchB;
+		} else {
+			const bool bit = (press.mValue >> (press.mBitsCount - pair)) & 1;
+			usecA = bit ? mUsecData1A : mUsecData0A;
+			usecB = bit ? mUsecData1B : mUsecData0B;
+		}
+	} else if(pair == 0) {
+		usecA = mUsecSynchA;
+		usecB = mUsecSynchB;
+	} else {
+		usecA = mUsecSynchA;
+		usecB = press.mUsecPause;
+	}
+}
+
+bool ButtonTrafficSource::nextPulse(uint32_t& usecDuration, int& pinLevel) {
+	if(mCycle >= mCyclesCount || mButtonPressesCount == 0) {
+		return false;
+	}
+	const ButtonPress& press = mButtonPresses[mPressIndex];
+	uint32_t usecA = 0;
+	uint32_t usecB = 0;
+	pulsePair(press, usecA, usecB);
+	if(not mSecondPulse) {
+		usecDuration = usecA;
+		pinLevel = mFirstPulseEndLevel;
+		mSecondPulse = true;
+	} else {
+		usecDuration = usecB;
+		pinLevel = not mFirstPulseEndLevel;
+		mSecondPulse = false;
+		const size_t pairsCount = press.mRepeats * (press.mBitsCount + 1) + 2;
+		if(++mPairIndex == pairsCount) {
+			mPairIndex = 0;
+			if(++mPressIndex == mButtonPressesCount) {
+				mPressIndex = 0;
+				++mCycle;
+			}
+		}
+	}
+	return true;
+}
+
+SensorTrafficSource::SensorTrafficSource(const uint32_t usecClock, const uint32_t synchA, const uint32_t synchB,
+		const uint32_t data0A, const uint32_t data0B, const uint32_t data1A, const uint32_t data1B,
+		Sensor* sensors, const size_t sensorsCount, const size_t bitsCount, const size_t repeats,
+		const uint32_t usecNoiseMin, const uint32_t usecNoiseMax)
+	: mUsecSynchA(usecClock * synchA), mUsecSynchB(usecClock * synchB)
+	, mUsecData0A(usecClock * data0A), mUsecData0B(usecClock * data0B)
+	, mUsecData1A(usecClock * data1A), mUsecData1B(usecClock * data1B)
+	, mSensors(sensors), mSensorsCount(sensorsCount), mBitsCount(bitsCount), mRepeats(repeats)
+	, mUsecNoiseMin(usecNoiseMin), mUsecNoiseMax(usecNoiseMax)
+	, mUsecNow(0), mRandom(4711), mPinLevel(1), mBurstSensor(nullptr), mBurstPulseIndex(0) {
+	for(size_t i = 0; i < mSensorsCount; i++) {
+		mSensors[i].mUsecNextBurst = mSensors[i].mUsecPhase;
+	}
+}
+
+/**
+ * A burst consists of mRepeats times a synch pulse pair followed by the
+ * data pulse pairs. Another synch pulse pair completes the last message
+ * packet. The final pulse pair holds a pause, that is too long for a synch
+ * pulse.
+ */
+uint32_t SensorTrafficSource::burstPulse(const Sensor& sensor, const size_t pulseIndex) const {
+	const size_t pairsPerPacket = mBitsCount + 1;
+	const size_t pairIndex = pulseIndex / 2;
+	const bool bSecond = pulseIndex & 1;
+	const size_t packet = pairIndex / pairsPerPacket;
+	const size_t pair = pairIndex % pairsPerPacket;
+	if(packet < mRepeats && pair > 0) {
+		const bool bit = (sensor.mValue >> (mBitsCount - pair)) & 1;
+		return bit ? (bSecond ? mUsecData1B : mUsecData1A) : (bSecond ? mUsecData0B : mUsecData0A);
+	}
+	if(packet < mRepeats || pair == 0) {
+		return bSecond ? mUsecSynchB : mUsecSynchA;
+	}
+	return bSecond ? 2 * mUsecSynchB : mUsecSynchA;
+}
+
+bool SensorTrafficSource::nextPulse(uint32_t& usecDuration, int& pinLevel) {
+	if(not mBurstSensor && mPinLevel) {
+		/* A burst starts with a pulse, that ends at level LO. */
+		for(size_t i = 0; i < mSensorsCount && not mBurstSensor; i++) {
+			Sensor& sensor = mSensors[i];
+			if(mUsecNow >= sensor.mUsecNextBurst) {
+				while(mUsecNow >= sensor.mUsecNextBurst) {
+					sensor.mUsecNextBurst += sensor.mUsecInterval;
+				}
+				if(sensor.mActive) {
+					mBurstSensor = &sensor;
+					mBurstPulseIndex = 0;
+				}
+			}
+		}
+	}
+
+	if(mBurstSensor) {
+		usecDuration = burstPulse(*mBurstSensor, mBurstPulseIndex);
+		const size_t pulsesCount = 2 * (mRepeats * (mBitsCount + 1) + 2);
+		if(++mBurstPulseIndex == pulsesCount) {
+			mBurstSensor = nullptr;
+		}
+	} else {
+		mRandom = mRandom * 1103515245 + 12345;
+		usecDuration = mUsecNoiseMin + (mRandom >> 8) % (mUsecNoiseMax - mUsecNoiseMin);
+	}
+	mPinLevel = not mPinLevel;
+	pinLevel = mPinLevel;
+	mUsecNow += usecDuration;
+	return true;
+}
+
+VirtualTimeScheduler::VirtualTimeScheduler(Receiver& receiver, PulseSource& pulseSource,
+		LoopTask& loopTask, const uint32_t usecLoopPeriod)
+	: mReceiver(receiver), mPulseSource(pulseSource), mLoopTask(loopTask)
+	, mUsecLoopPeriod(usecLoopPeriod), mEdgePending(false), mPinLevel(0)
+	, mUsecNextEdge(VirtualClock::now()), mUsecNextLoop(VirtualClock::now() + usecLoopPeriod)
+	, mEdgesCount(0), mLoopsCount(0) {
+	fetchEdge();
+}
+
+void VirtualTimeScheduler::fetchEdge() {
+	uint32_t usecDuration = 0;
+	mEdgePending = mPulseSource.nextPulse(usecDuration, mPinLevel);
+	if(mEdgePending) {
+		mUsecNextEdge += usecDuration;
+	}
+}
+
+void VirtualTimeScheduler::runFor(const uint64_t usecDuration) {
+	const uint64_t usecEnd = VirtualClock::now() + usecDuration;
+	while(true) {
+		if(mEdgePending && mUsecNextEdge <= mUsecNextLoop) {
+			if(mUsecNextEdge > usecEnd) {
+				break;
+			}
+			VirtualClock::advanceTo(mUsecNextEdge);
+			ReceiverTestAccess::handleInterrupt(mReceiver, mPinLevel, VirtualClock::micros());
+			++mEdgesCount;
+			fetchEdge();
+		} else {
+			if(mUsecNextLoop > usecEnd) {
+				break;
+			}
+			VirtualClock::advanceTo(mUsecNextLoop);
+			mLoopTask.loop();
+			++mLoopsCount;
+			mUsecNextLoop += mUsecLoopPeriod;
+		}
+	}
+	VirtualClock::advanceTo(usecEnd);
+}
+
+} // namespace RcSwitch
+
+#endif // #ifdef ENABLE_RCSWITCH_TEST
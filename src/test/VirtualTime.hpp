@@ -0,0 +1,231 @@
+/*
+  RcSwitchReceiver - Arduino libary for remote control receiver Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RcSwitchReceiver/
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RCSWITCH_RECEIVER_TEST_VIRTUALTIME_HPP_
+#define RCSWITCH_RECEIVER_TEST_VIRTUALTIME_HPP_
+
+#ifdef ENABLE_RCSWITCH_TEST
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace RcSwitch {
+
+class Receiver;
+
+/**
+ * A clock that replaces the system time while it is started. The library
+ * reads the time through RcSwitch::micros_() and RcSwitch::millis_(), which
+ * return the virtual time then, because start() sets RcSwitch::usecTimeHook.
+ * So timing dependent components can be tested without waiting for real
+ * time to pass.
+ * The virtual time is kept with 64 bits. micros_() and millis_() wrap
+ * around like the Arduino functions do.
+ */
+class VirtualClock {
+	static uint64_t mUsecNow;
+public:
+	static void start(const uint64_t usecNow = 0);
+	static void stop();
+	static bool isActive();
+
+	/** Move the virtual time forward. The time never moves backwards. */
+	static void advanceTo(const uint64_t usecTime) {
+		if(usecTime > mUsecNow) {
+			mUsecNow = usecTime;
+		}
+	}
+
+	static inline uint64_t now() {return mUsecNow;}
+	static inline uint32_t micros() {return static_cast<uint32_t>(mUsecNow);}
+	static inline uint32_t millis() {return static_cast<uint32_t>(mUsecNow / 1000);}
+};
+
+/**
+ * A source of simulated radio frequency pulses.
+ */
+class PulseSource {
+public:
+	/**
+	 * Provide the next pulse. pinLevel is the level of the IO pin after the
+	 * pulse has ended, which is what the interrupt handler reads.
+	 * Returns false, if there are no more pulses.
+	 */
+	virtual bool nextPulse(uint32_t& usecDuration, int& pinLevel) = 0;
+	virtual ~PulseSource() {}
+};
+
+/**
+ * Simulates remote control button traffic. Each button press is sent as
+ * repeated message packets, followed by a pause. The list of button presses
+ * is sent cyclesCount times.
+ * The pulse timing is given the same way as for makeTimingSpec.
+ */
+class ButtonTrafficSource : public PulseSource {
+public:
+	struct ButtonPress {
+		uint32_t mValue;
+		size_t mBitsCount;
+		size_t mRepeats;
+		uint32_t mUsecPause;
+	};
+
+private:
+	const uint32_t mUsecSynchA;
+	const uint32_t mUsecSynchB;
+	const uint32_t mUsecData0A;
+	const uint32_t mUsecData0B;
+	const uint32_t mUsecData1A;
+	const uint32_t mUsecData1B;
+	const int mFirstPulseEndLevel;
+
+	const ButtonPress* const mButtonPresses;
+	const size_t mButtonPressesCount;
+	const size_t mCyclesCount;
+
+	size_t mCycle;
+	size_t mPressIndex;
+	/** Index of the pulse pair within the current button press. */
+	size_t mPairIndex;
+	bool mSecondPulse;
+
+	void pulsePair(const ButtonPress& press, uint32_t& usecA, uint32_t& usecB) const;
+
+public:
+	ButtonTrafficSource(const uint32_t usecClock, const uint32_t synchA, const uint32_t synchB,
+			const uint32_t data0A, const uint32_t data0B, const uint32_t data1A, const uint32_t data1B,
+			const bool inverseLevel, const ButtonPress* buttonPresses, const size_t buttonPressesCount,
+			const size_t cyclesCount);
+
+	bool nextPulse(uint32_t& usecDuration, int& pinLevel) override;
+};
+
+/**
+ * Simulates periodic sensors within permanent noise. Each sensor sends a
+ * burst of repeated message packets every interval. Noise pulses of random
+ * duration fill the time between the bursts.
+ * The pulse timing is given the same way as for makeTimingSpec.
+ */
+class SensorTrafficSource : public PulseSource {
+public:
+	struct Sensor {
+		uint32_t mValue;
+		uint32_t mUsecInterval;
+		uint32_t mUsecPhase;
+		/** An inactive sensor skips its bursts. */
+		bool mActive;
+		/** Maintained by the traffic source. */
+		uint64_t mUsecNextBurst;
+	};
+
+private:
+	const uint32_t mUsecSynchA;
+	const uint32_t mUsecSynchB;
+	const uint32_t mUsecData0A;
+	const uint32_t mUsecData0B;
+	const uint32_t mUsecData1A;
+	const uint32_t mUsecData1B;
+
+	Sensor* const mSensors;
+	const size_t mSensorsCount;
+	const size_t mBitsCount;
+	const size_t mRepeats;
+	const uint32_t mUsecNoiseMin;
+	const uint32_t mUsecNoiseMax;
+
+	uint64_t mUsecNow;
+	uint32_t mRandom;
+	int mPinLevel;
+
+	/** The sensor whose burst is being sent, or nullptr. */
+	const Sensor* mBurstSensor;
+	/** Index of the pulse within the current burst. */
+	size_t mBurstPulseIndex;
+
+	uint32_t burstPulse(const Sensor& sensor, const size_t pulseIndex) const;
+
+public:
+	SensorTrafficSource(const uint32_t usecClock, const uint32_t synchA, const uint32_t synchB,
+			const uint32_t data0A, const uint32_t data0B, const uint32_t data1A, const uint32_t data1B,
+			Sensor* sensors, const size_t sensorsCount, const size_t bitsCount, const size_t repeats,
+			const uint32_t usecNoiseMin, const uint32_t usecNoiseMax);
+
+	bool nextPulse(uint32_t& usecDuration, int& pinLevel) override;
+};
+
+/**
+ * A discrete event scheduler, that interleaves the simulated pulse edges
+ * with periodic calls of the application loop, ordered by virtual time.
+ * The virtual clock is advanced to the time of each event before the
+ * event is dispatched. An edge wins against a loop call at the same time,
+ * like an interrupt would.
+ * Hours of traffic are simulated within a fraction of a second.
+ */
+class VirtualTimeScheduler {
+public:
+	class LoopTask {
+	public:
+		virtual void loop() = 0;
+		virtual ~LoopTask() {}
+	};
+
+private:
+	Receiver& mReceiver;
+	PulseSource& mPulseSource;
+	LoopTask& mLoopTask;
+	const uint32_t mUsecLoopPeriod;
+
+	bool mEdgePending;
+	int mPinLevel;
+	uint64_t mUsecNextEdge;
+	uint64_t mUsecNextLoop;
+
+	uint32_t mEdgesCount;
+	uint32_t mLoopsCount;
+
+	void fetchEdge();
+
+public:
+	/** The virtual clock must have been started before. */
+	VirtualTimeScheduler(Receiver& receiver, PulseSource& pulseSource, LoopTask& loopTask,
+			const uint32_t usecLoopPeriod);
+
+	/**
+	 * Dispatch all events until the virtual time has moved forward by
+	 * usecDuration.
+	 */
+	void runFor(const uint64_t usecDuration);
+
+	uint32_t edgesCount() const {return mEdgesCount;}
+	uint32_t loopsCount() const {return mLoopsCount;}
+};
+
+} // namespace RcSwitch
+
+#endif // #ifdef ENABLE_RCSWITCH_TEST
+
+#endif /* RCSWITCH_RECEIVER_TEST_VIRTUALTIME_HPP_ */